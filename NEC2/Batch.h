@@ -0,0 +1,253 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common.h"
+#include "Random.h"
+#include "SolutionTemplate.h"
+
+/**
+* Solving many instances in one run.
+*
+* The nightly planning gives us dozens of independent problems, and starting `./main` for each of them pays the process start,
+* the threads and the printing of the whole template every time. Here they are all read at once, quietly,
+* and solved by a pool of workers, each of them with `instance_threads` threads, taking the next instance as soon as it's done with one.
+* The biggest instances (by the number of tasks) go first: the small ones fill the gaps at the end,
+* instead of one big instance starting last and keeping the whole run waiting for it.
+*
+* The batch is a directory (every `.txt` file in it) or a manifest, one instance per line:
+*     la40seti5.txt 60
+*     nightly/plant2.txt
+* the optional number is the time limit of that instance in seconds, the ones without it get the default time limit.
+* Relative paths in the manifest are relative to the manifest itself, `#` starts a comment.
+*
+* Every instance gives one JSON line in the results file, written as soon as it's solved, in the order they finish:
+*     {"instance": "la40seti5.txt", "jobs": 15, "machines": 15, "tasks": 225, "lower_bound": 1165, "total_runtime": 1252,
+*      "time_limit": 60, "seconds": 60.01, "start_times": [...]}
+* or `{"instance": ..., "error": ...}` if it couldn't be read. The start times are in the order of the tasks in the problem file.
+*/
+
+struct BatchInstance
+{
+	std::string filename;
+	double time_limit; // in seconds, 0 means no limit
+	int number; // in the directory listing or in the manifest, the seeds go by it
+	SolutionTemplate solution_template;
+	std::string error; // empty if the instance was read fine
+};
+
+/* the solver of one instance: template, instance, number of threads, seed */
+typedef std::function<Chromosome(SolutionTemplate&, const BatchInstance&, int, uint64_t)> BatchSolver;
+
+struct BatchSettings
+{
+	std::string path; // directory or manifest
+	std::string results_filename;
+	double time_limit; // of the instances which don't have their own
+	int threads; // shared by all the instances
+	int instance_threads; // threads of one instance
+};
+
+/* the instances of the directory or the manifest with their time limits, not read yet */
+inline std::vector<std::unique_ptr<BatchInstance>> list_batch_instances(const BatchSettings& settings)
+{
+	namespace fs = std::filesystem;
+	std::vector<std::unique_ptr<BatchInstance>> instances;
+	auto add = [&](const std::string& filename, double time_limit) {
+		const int number = static_cast<int>(instances.size());
+		instances.push_back(std::make_unique<BatchInstance>(BatchInstance{ filename, time_limit, number, SolutionTemplate(), "" }));
+	};
+
+	if (fs::is_directory(settings.path))
+	{
+		std::vector<std::string> filenames;
+		for (const auto& entry : fs::directory_iterator(settings.path))
+		{
+			if (entry.is_regular_file() && entry.path().extension() == ".txt")
+			{
+				filenames.push_back(entry.path().string());
+			}
+		}
+		// the directory order is whatever the file system likes, the numbers (and the seeds) shouldn't depend on it
+		std::sort(filenames.begin(), filenames.end());
+		for (const auto& filename : filenames)
+		{
+			add(filename, settings.time_limit);
+		}
+		return instances;
+	}
+
+	std::ifstream manifest(settings.path);
+	if (!manifest.is_open())
+	{
+		throw std::runtime_error("Failed to open the batch " + settings.path + ", it's neither a directory nor a manifest.");
+	}
+	const fs::path base = fs::path(settings.path).parent_path();
+	std::string line;
+	int line_number{ 0 };
+	while (std::getline(manifest, line))
+	{
+		++line_number;
+		std::istringstream fields(line.substr(0, line.find('#')));
+		std::string filename;
+		if (!(fields >> filename))
+		{
+			continue;
+		}
+		double time_limit = settings.time_limit;
+		std::string extra;
+		if (fields >> extra)
+		{
+			std::istringstream number(extra);
+			if (!(number >> time_limit) || time_limit < 0.0 || !number.eof() || (fields >> extra))
+			{
+				throw std::runtime_error(settings.path + ":" + std::to_string(line_number) + ": expected a file name and an optional time limit in seconds.");
+			}
+		}
+		add(fs::path(filename).is_absolute() ? filename : (base / filename).string(), time_limit);
+	}
+	return instances;
+}
+
+/* JSON strings for the file names and the error messages */
+inline std::string json_string(const std::string& text)
+{
+	std::string result = "\"";
+	for (const char c : text)
+	{
+		if (c == '"' || c == '\\')
+		{
+			result += '\\';
+			result += c;
+		}
+		else if (static_cast<unsigned char>(c) < 0x20)
+		{
+			char escaped[8];
+			std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+			result += escaped;
+		}
+		else
+		{
+			result += c;
+		}
+	}
+	return result + "\"";
+}
+
+/**
+* Solves all the instances of the batch, see above.
+* Returns the number of instances which failed.
+*/
+inline int solve_batch(const BatchSettings& settings, const BatchSolver& solve, uint64_t seed)
+{
+	auto instances = list_batch_instances(settings);
+	std::ofstream results(settings.results_filename);
+	if (!results.is_open())
+	{
+		throw std::runtime_error("Failed to open the results file " + settings.results_filename + ".");
+	}
+
+	// reading is cheap next to solving, so it's done once here, the sizes are needed for the order anyway
+	for (auto& instance : instances)
+	{
+		try
+		{
+			read_problem(instance->filename, instance->solution_template);
+		}
+		catch (const std::exception& error)
+		{
+			instance->error = error.what();
+		}
+	}
+	std::stable_sort(instances.begin(), instances.end(), [](const auto& a, const auto& b) {
+		return a->solution_template.get_graph().tasks_count() > b->solution_template.get_graph().tasks_count();
+		});
+
+	const int instance_threads = std::min(settings.instance_threads, settings.threads);
+	const int workers_count = std::max(1, std::min(settings.threads / instance_threads, static_cast<int>(instances.size())));
+	std::cout << "Batch of " << instances.size() << " instances from " << settings.path << ", " << workers_count << " at a time on "
+		<< instance_threads << " threads each.\n";
+
+	std::mutex results_mutex;
+	std::atomic<int> next_instance{ 0 };
+	std::atomic<int> failed{ 0 };
+	auto work = [&]() {
+		for (int i = next_instance.fetch_add(1); i < static_cast<int>(instances.size()); i = next_instance.fetch_add(1))
+		{
+			BatchInstance& instance = *instances[i];
+			Chromosome best;
+			double seconds{ 0.0 };
+			if (instance.error.empty())
+			{
+				CounterRandom random_engine(seed, 0, static_cast<uint32_t>(instance.number), RandomStream::Batch);
+				const uint64_t instance_seed = (static_cast<uint64_t>(random_engine()) << 32) | random_engine();
+				const auto start = std::chrono::steady_clock::now();
+				try
+				{
+					best = solve(instance.solution_template, instance, instance_threads, instance_seed);
+				}
+				catch (const std::exception& error)
+				{
+					// an instance the solver can't handle gets its error record, the rest of the batch carries on
+					instance.error = error.what();
+				}
+				seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			}
+
+			std::ostringstream record;
+			record << "{\"instance\": " << json_string(instance.filename);
+			if (!instance.error.empty())
+			{
+				record << ", \"error\": " << json_string(instance.error) << "}\n";
+				++failed;
+			}
+			else
+			{
+				SolutionTemplate& solution_template = instance.solution_template;
+				const PrecedenceGraph& graph = solution_template.get_graph();
+				solution_template.fill_start_times(best);
+				record << ", \"jobs\": " << graph.jobs_count() << ", \"machines\": " << graph.machines_count() << ", \"tasks\": " << graph.tasks_count()
+					<< ", \"lower_bound\": " << solution_template.absolute_lowest_bound() << ", \"total_runtime\": " << solution_template.total_runtime()
+					<< ", \"time_limit\": " << instance.time_limit << ", \"seconds\": " << seconds << ", \"start_times\": [";
+				for (size_t task = 0; task < best.size(); ++task)
+				{
+					record << (task == 0 ? "" : ", ") << best[task];
+				}
+				record << "]}\n";
+			}
+
+			std::lock_guard<std::mutex> lock(results_mutex);
+			// flushed every time, so the records of the solved instances survive whatever happens to the rest of the batch
+			results << record.str() << std::flush;
+			std::cout << "Instance " << instance.filename << ": "
+				<< (instance.error.empty() ? "total runtime " + std::to_string(instance.solution_template.total_runtime()) : instance.error) << "\n";
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (int i = 1; i < workers_count; ++i)
+	{
+		workers.emplace_back(work);
+	}
+	work();
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+
+	std::cout << "Batch done: " << instances.size() - failed.load() << " solved, " << failed.load() << " failed, results in " << settings.results_filename << "\n";
+	return failed;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "common.h"
+#include "Kernels.h"
+#include "PrecedenceGraph.h"
+
+/**
+* Evaluates a batch of chromosomes at once, one chromosome per SIMD lane.
+*
+* All the chromosomes of the problem share the same jobs and machines, so evaluating several of them
+* is exactly the same control flow over different start times.
+* We lay the tile out column-wise: `tile[task * BATCH_LANES + lane]` is the start time of `task` in the chromosome in `lane`,
+* so every step of the loops below processes the same task in all the lanes with one vector instruction.
+*
+* The evaluation is:
+* 1. precedence propagation along the jobs: a task cannot start before its predecessor in the job ends.
+*    Chromosomes coming out of the operators are already free of conflicts, so this changes nothing for them,
+*    but it guarantees we never report a runtime shorter than the sequence of the jobs allows.
+* 2. max-reduction of the end times of the last tasks of the jobs, which is the total runtime.
+*
+* Machine-level conflicts are NOT looked at, the order on machines differs from lane to lane.
+* Same as the old fitness pass, this relies on the operators resolving the conflicts.
+*/
+constexpr int BATCH_LANES = 16;
+
+class BatchEvaluator
+{
+private:
+	const PrecedenceGraph& graph;
+	std::vector<int> tile;
+	int lanes_used{ 0 };
+
+public:
+	explicit BatchEvaluator(const PrecedenceGraph& graph)
+		: graph(graph), tile(static_cast<size_t>(graph.tasks_count()) * BATCH_LANES, 0)
+	{
+	}
+
+	bool is_full() const
+	{
+		return lanes_used == BATCH_LANES;
+	}
+
+	int size() const
+	{
+		return lanes_used;
+	}
+
+	/* puts the chromosome into the next free lane */
+	template <typename Gene>
+	void add(const BasicChromosome<Gene>& start_times)
+	{
+		const int lane = lanes_used++;
+		for (int task_index = 0; task_index < graph.tasks_count(); ++task_index)
+		{
+			tile[task_index * BATCH_LANES + lane] = start_times[task_index];
+		}
+	}
+
+	/*
+	 * Writes the total runtimes of the chromosomes in the order they were added, and empties the batch.
+	 * Unused lanes hold whatever was there before, they are computed and ignored.
+	 */
+	NEC_TARGET_CLONES void evaluate(int* total_runtimes)
+	{
+		int result[BATCH_LANES] = {};
+
+		for (int job_id = 0; job_id < graph.jobs_count(); ++job_id)
+		{
+			const int job_begin = graph.job_offsets[job_id];
+			const int job_end = graph.job_offsets[job_id + 1];
+			for (int i = job_begin + 1; i < job_end; ++i)
+			{
+				const int previous = graph.job_tasks[i - 1];
+				const int length = graph.lengths[previous];
+				const int* previous_starts = tile.data() + previous * BATCH_LANES;
+				int* starts = tile.data() + graph.job_tasks[i] * BATCH_LANES;
+				for (int lane = 0; lane < BATCH_LANES; ++lane)
+				{
+					starts[lane] = std::max(starts[lane], previous_starts[lane] + length);
+				}
+			}
+
+			const int last = graph.job_tasks[job_end - 1];
+			const int length = graph.lengths[last];
+			const int* last_starts = tile.data() + last * BATCH_LANES;
+			for (int lane = 0; lane < BATCH_LANES; ++lane)
+			{
+				result[lane] = std::max(result[lane], last_starts[lane] + length);
+			}
+		}
+
+		std::copy(result, result + lanes_used, total_runtimes);
+		lanes_used = 0;
+	}
+};
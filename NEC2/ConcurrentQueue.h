@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+/**
+* Bounded lock-free queue for many producers and many consumers (the one by Dmitry Vyukov).
+*
+* It's a ring of cells, each cell has a sequence number which tells whose turn it is:
+* equal to the position - the cell is free for the producer at that position,
+* position + 1 - the cell is full and ready for the consumer at that position.
+* A producer or a consumer claims a position with one CAS and then has the cell for itself, nobody ever waits on a lock.
+*
+* Neither of the operations blocks: `try_push()` fails if the queue is full, `try_pop()` if it's empty,
+* what to do then (spin, yield, do something else) is the caller's decision.
+*/
+template <typename T>
+class ConcurrentQueue
+{
+private:
+	struct Cell
+	{
+		std::atomic<size_t> sequence;
+		T value;
+	};
+
+	// the positions are on their own cache lines, so the producers and the consumers don't invalidate each other's
+	static constexpr size_t CACHE_LINE = 64;
+
+	const size_t mask;
+	std::unique_ptr<Cell[]> cells;
+	alignas(CACHE_LINE) std::atomic<size_t> push_position{ 0 };
+	alignas(CACHE_LINE) std::atomic<size_t> pop_position{ 0 };
+
+	static size_t round_up_to_power_of_two(size_t capacity)
+	{
+		size_t result = 2;
+		while (result < capacity)
+		{
+			result *= 2;
+		}
+		return result;
+	}
+
+public:
+	/* the capacity is rounded up to the power of two */
+	explicit ConcurrentQueue(size_t capacity)
+		: mask(round_up_to_power_of_two(capacity) - 1), cells(new Cell[mask + 1])
+	{
+		for (size_t i = 0; i <= mask; ++i)
+		{
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	ConcurrentQueue(const ConcurrentQueue&) = delete;
+	ConcurrentQueue& operator=(const ConcurrentQueue&) = delete;
+
+	size_t capacity() const
+	{
+		return mask + 1;
+	}
+
+	/* moves the value in, returns false (and leaves the value alone) if the queue is full */
+	bool try_push(T&& value)
+	{
+		size_t position = push_position.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			Cell& cell = cells[position & mask];
+			const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+			const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+			if (difference == 0)
+			{
+				if (push_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					cell.value = std::move(value);
+					cell.sequence.store(position + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (difference < 0)
+			{
+				return false;
+			}
+			else
+			{
+				position = push_position.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	/* moves the oldest value out, returns false if the queue is empty */
+	bool try_pop(T& value)
+	{
+		size_t position = pop_position.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			Cell& cell = cells[position & mask];
+			const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+			const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+			if (difference == 0)
+			{
+				if (pop_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					value = std::move(cell.value);
+					cell.sequence.store(position + mask + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (difference < 0)
+			{
+				return false;
+			}
+			else
+			{
+				position = pop_position.load(std::memory_order_relaxed);
+			}
+		}
+	}
+};
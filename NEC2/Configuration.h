@@ -0,0 +1,517 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "GeneticAlgorithm.h"
+#include "SimulatedAnnealing.h"
+#include "Portfolio.h"
+
+/**
+* All the settings of the run.
+*
+* The values below are the defaults, and every one of them can be overridden without recompiling:
+* - from the command line: `--population_size 2000` or `--population_size=2000` (dashes work too: `--population-size`)
+* - from an INI-style file given with `--config run.ini`: one `name = value` per line, `#` and `;` start comments,
+*   `[sections]` are allowed for grouping but ignored.
+* Options are applied left to right, so the command line after `--config` overrides the file.
+* `--help` lists all the names with their current values.
+*/
+struct Configuration
+{
+	// seed of the whole run, 0 means "take a random one", the seed used is printed so the run can be repeated
+	uint64_t random_seed = 0;
+
+	std::string problem_filename = "la40seti5.txt";
+	std::string solver_type = "genetic"; // "genetic", "annealing", "parallel tempering", "island coordinator" or "portfolio"
+	std::string crossover_type = "2-point"; // "1-point", "2-point" or "uniform"
+	std::string selection_type = "tainted"; // "tainted" puts the worst specimen back into the population, "pure" doesn't
+	std::string mutation_type = "uniform XOR"; // "singular", "uniform XOR" or "uniform additive"
+	std::string decoder_type = "compacting"; // "compacting" left-shifts every repaired chromosome to its earliest feasible start times, "push-later" doesn't
+
+	// number of worker threads for the parallel parts of the solvers, 0 means all the hardware threads
+	int threads = 0;
+
+	// wall clock limit of the solver in seconds, 0 means no limit, the solver stops at the end of the current generation or round
+	double time_limit = 0.0;
+
+	// where to write the best schedule, empty means only print it
+	std::string solution_filename = "";
+
+	// where to stream every new best schedule as soon as it's found, one JSON line each (see Improvements.h), empty means nowhere
+	// a named pipe works too, the run doesn't wait for its reader
+	std::string improvements_filename = "";
+
+	// "generational" replaces the worse half of the population at once,
+	// "steady-state" breeds one pair at a time from the tournament winners and replaces the worst specimen,
+	// "asynchronous" is steady-state with the pairs bred by `threads` workers, not repeatable with the same seed,
+	// "pipelined" is generational with every block of pairs going through breeding, mutation, evaluation and sorting in one go
+	std::string genetic_mode = "generational";
+	int tournament_size = 4; // steady state and asynchronous only
+	long long evaluations = 0; // steady state and asynchronous only, number of children to evaluate, 0 means `generations` * `population_size` / 2
+
+	// set the number of chromosomes in the population, must be a multiple of 4 as the better half breeds in pairs
+	int population_size = 10000;
+
+	// set the number of generations
+	int generations = 500;
+
+	// set the probability of mutation
+	int mutation_probability = 10;
+	int min_mutation_value = -2;
+	int max_mutation_value = 2;
+
+	// whether we replace the duplicate schedules in the population with heavily mutated copies
+	// in a converged population most of the pairs are clones and their offspring are the same clones again
+	bool is_duplicate_elimination_enabled = true;
+	int heavy_mutation_value = 20; // every start time of the duplicate is moved by up to this value in both directions
+	int diversity_sample_size = 32; // specimens compared pairwise for the diversity in the progress output
+
+	// number of the remembered repairs, the children of the late generations are mostly clones and they are not repaired or evaluated again, 0 disables it
+	int fitness_cache_capacity = 4096;
+
+	// settings of the simulated annealing and the parallel tempering, temperatures are in units of makespan
+	double initial_temperature = 50.0;
+	double final_temperature = 0.5;
+	long long iterations = 2000000;
+	std::string cooling_schedule = "geometric"; // "geometric", "linear" or "lundy-mees"
+	int critical_move_probability = 90;
+	std::string move_evaluation = "estimate"; // "exact" or "estimate"
+	int tempering_replicas = 4; // each replica runs on its own thread
+	int tempering_exchange_interval = 1000; // iterations between the replica exchanges
+
+	// the island model over processes, see Island.h
+	// a genetic run with the address set joins the coordinator at it as one more island,
+	// the "island coordinator" solver listens at it and waits for `islands` of them
+	std::string island_address = ""; // "unix:/path" or "tcp:host:port"
+	int islands = 2;
+	int migration_interval = 10; // generations between the migrations
+	int migrants = 4; // best specimens every island sends away on every migration
+
+	// the portfolio races these solvers on the `threads`, see Portfolio.h
+	// a GA is "crossover/selection/mutation/decoder" and runs in the `genetic_mode` with the settings above, "annealing" is the annealing
+	std::string portfolio = "2-point/pure/uniform XOR/compacting, 1-point/tainted/singular/compacting, 2-point/tainted/uniform XOR/push-later, annealing";
+	double portfolio_round_time = 5.0; // seconds between the reallocations of the threads
+	int portfolio_rounds = 20; // the run also stops at the time limit
+
+	// many instances in one run, see Batch.h: a directory of problem files or a manifest, `problem_filename` is ignored then
+	// every instance is solved by `solver_type` ("genetic", "annealing" or "parallel tempering") with the time limit of the manifest or `time_limit`
+	std::string batch = "";
+	std::string batch_results = "batch_results.jsonl"; // one JSON line per instance
+	int batch_instance_threads = 1; // threads of one instance, `threads` / this many instances are solved at a time
+
+	// a long-running server solving the problems sent to it, see Server.h: "stdin", "unix:/path" or "tcp:host:port"
+	// the problems are solved one at a time by `solver_type` ("genetic", "annealing" or "parallel tempering") on all the `threads`
+	std::string serve = "";
+
+	/* `threads` with 0 resolved to the number of the hardware threads */
+	int thread_count() const
+	{
+		if (threads > 0)
+		{
+			return threads;
+		}
+		return std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	/* throws if the values can't work together, called once after all the options are applied */
+	void validate() const
+	{
+		if (population_size < 4 || population_size % 4 != 0)
+		{
+			throw std::runtime_error("population_size must be a positive multiple of 4.");
+		}
+		if (generations < 1)
+		{
+			throw std::runtime_error("generations must be at least 1.");
+		}
+		if (mutation_probability < 0 || mutation_probability > 100 || critical_move_probability < 0 || critical_move_probability > 100)
+		{
+			throw std::runtime_error("Probabilities are in percents, between 0 and 100.");
+		}
+		if (min_mutation_value > max_mutation_value || heavy_mutation_value < 0)
+		{
+			throw std::runtime_error("Mutation values make an empty range.");
+		}
+		if (diversity_sample_size < 0)
+		{
+			throw std::runtime_error("diversity_sample_size can't be negative.");
+		}
+		if (fitness_cache_capacity < 0)
+		{
+			throw std::runtime_error("fitness_cache_capacity can't be negative.");
+		}
+		if (threads < 0 || time_limit < 0.0)
+		{
+			throw std::runtime_error("threads and time_limit can't be negative.");
+		}
+		if (solver_type != "genetic" && solver_type != "annealing" && solver_type != "parallel tempering" && solver_type != "island coordinator" && solver_type != "portfolio")
+		{
+			throw std::runtime_error("solver_type must be \"genetic\", \"annealing\", \"parallel tempering\", \"island coordinator\" or \"portfolio\".");
+		}
+		// these throw with the names they know, the registry is the only list of the GA configurations there is
+		find_genetic_solver(crossover_type, selection_type, mutation_type, decoder_type);
+		if (solver_type == "portfolio")
+		{
+			parse_portfolio_members(portfolio, SolutionTemplate());
+		}
+		if (genetic_mode != "generational" && genetic_mode != "steady-state" && genetic_mode != "asynchronous" && genetic_mode != "pipelined")
+		{
+			throw std::runtime_error("genetic_mode must be \"generational\", \"steady-state\", \"asynchronous\" or \"pipelined\".");
+		}
+		if (tournament_size < 1 || evaluations < 0)
+		{
+			throw std::runtime_error("tournament_size must be positive and evaluations non-negative.");
+		}
+		// throws with the names it knows
+		parse_cooling_schedule(cooling_schedule);
+		if (move_evaluation != "exact" && move_evaluation != "estimate")
+		{
+			throw std::runtime_error("move_evaluation must be \"exact\" or \"estimate\".");
+		}
+		if (tempering_replicas < 1 || tempering_exchange_interval < 1 || iterations < 1)
+		{
+			throw std::runtime_error("Annealing iterations, tempering replicas and exchange interval must be positive.");
+		}
+		// the geometric cooling and the tempering ladder take powers of final / initial, the lundy-mees one divides by both
+		if (initial_temperature <= 0.0 || final_temperature <= 0.0 || final_temperature > initial_temperature)
+		{
+			throw std::runtime_error("Temperatures must be positive and final_temperature can't be above initial_temperature.");
+		}
+		// the tempering runs iterations / tempering_exchange_interval rounds, with none it would return the initial schedule
+		if (iterations < tempering_exchange_interval)
+		{
+			throw std::runtime_error("iterations can't be less than tempering_exchange_interval.");
+		}
+		if (islands < 1 || migration_interval < 1 || migrants < 0)
+		{
+			throw std::runtime_error("islands and migration_interval must be positive and migrants non-negative.");
+		}
+		if (solver_type == "island coordinator" && island_address.empty())
+		{
+			throw std::runtime_error("The island coordinator needs island_address to listen at.");
+		}
+		if (solver_type == "genetic" && !island_address.empty() && genetic_mode != "generational" && genetic_mode != "pipelined")
+		{
+			throw std::runtime_error("Only the generational and the pipelined GA can be islands.");
+		}
+		if (portfolio_round_time <= 0.0 || portfolio_rounds < 1)
+		{
+			throw std::runtime_error("portfolio_round_time and portfolio_rounds must be positive.");
+		}
+		if (solver_type == "portfolio" && genetic_mode != "generational" && genetic_mode != "pipelined")
+		{
+			throw std::runtime_error("Only the generational and the pipelined GA can be in the portfolio.");
+		}
+		if (!batch.empty() && ((solver_type != "genetic" && solver_type != "annealing" && solver_type != "parallel tempering") || !island_address.empty()))
+		{
+			throw std::runtime_error("The batch is solved by \"genetic\", \"annealing\" or \"parallel tempering\", and not as islands.");
+		}
+		if (!serve.empty() && ((solver_type != "genetic" && solver_type != "annealing" && solver_type != "parallel tempering") || !island_address.empty() || !batch.empty()))
+		{
+			throw std::runtime_error("The server solves with \"genetic\", \"annealing\" or \"parallel tempering\", not as an island and not with a batch.");
+		}
+		if (batch_instance_threads < 1)
+		{
+			throw std::runtime_error("batch_instance_threads must be positive.");
+		}
+	}
+};
+
+/**
+* Parses the options into the configuration.
+* Every option is a name, a setter from the string, and a getter for `--help`.
+*/
+class ConfigurationParser
+{
+private:
+	struct Option
+	{
+		std::string name;
+		std::function<void(Configuration&, const std::string&)> set;
+		std::function<std::string(const Configuration&)> get;
+	};
+
+	std::vector<Option> options;
+
+	static long long parse_integer(const std::string& name, const std::string& value)
+	{
+		size_t parsed_length = 0;
+		long long result = 0;
+		try
+		{
+			result = std::stoll(value, &parsed_length);
+		}
+		catch (const std::exception&)
+		{
+			parsed_length = 0;
+		}
+		if (parsed_length == 0 || parsed_length != value.size())
+		{
+			throw std::runtime_error("Option " + name + " expects an integer, got \"" + value + "\".");
+		}
+		return result;
+	}
+
+	static unsigned long long parse_unsigned(const std::string& name, const std::string& value)
+	{
+		size_t parsed_length = 0;
+		unsigned long long result = 0;
+		try
+		{
+			result = std::stoull(value, &parsed_length);
+		}
+		catch (const std::exception&)
+		{
+			parsed_length = 0;
+		}
+		if (parsed_length == 0 || parsed_length != value.size() || value.front() == '-')
+		{
+			throw std::runtime_error("Option " + name + " expects a non-negative integer, got \"" + value + "\".");
+		}
+		return result;
+	}
+
+	static double parse_real(const std::string& name, const std::string& value)
+	{
+		size_t parsed_length = 0;
+		double result = 0.0;
+		try
+		{
+			result = std::stod(value, &parsed_length);
+		}
+		catch (const std::exception&)
+		{
+			parsed_length = 0;
+		}
+		if (parsed_length == 0 || parsed_length != value.size())
+		{
+			throw std::runtime_error("Option " + name + " expects a number, got \"" + value + "\".");
+		}
+		return result;
+	}
+
+	static bool parse_boolean(const std::string& name, const std::string& value)
+	{
+		if (value == "true" || value == "1" || value == "yes" || value == "on")
+		{
+			return true;
+		}
+		if (value == "false" || value == "0" || value == "no" || value == "off")
+		{
+			return false;
+		}
+		throw std::runtime_error("Option " + name + " expects true or false, got \"" + value + "\".");
+	}
+
+	template <typename Value>
+	void add(const std::string& name, Value Configuration::* field)
+	{
+		Option option{ name, nullptr, nullptr };
+		if constexpr (std::is_same_v<Value, std::string>)
+		{
+			option.set = [field](Configuration& configuration, const std::string& value) { configuration.*field = value; };
+			option.get = [field](const Configuration& configuration) { return "\"" + configuration.*field + "\""; };
+		}
+		else if constexpr (std::is_same_v<Value, bool>)
+		{
+			option.set = [field, name](Configuration& configuration, const std::string& value) { configuration.*field = parse_boolean(name, value); };
+			option.get = [field](const Configuration& configuration) { return std::string(configuration.*field ? "true" : "false"); };
+		}
+		else if constexpr (std::is_floating_point_v<Value>)
+		{
+			option.set = [field, name](Configuration& configuration, const std::string& value) { configuration.*field = parse_real(name, value); };
+			option.get = [field](const Configuration& configuration) { std::ostringstream text; text << configuration.*field; return text.str(); };
+		}
+		else if constexpr (std::is_unsigned_v<Value>)
+		{
+			option.set = [field, name](Configuration& configuration, const std::string& value) { configuration.*field = static_cast<Value>(parse_unsigned(name, value)); };
+			option.get = [field](const Configuration& configuration) { return std::to_string(configuration.*field); };
+		}
+		else
+		{
+			option.set = [field, name](Configuration& configuration, const std::string& value) { configuration.*field = static_cast<Value>(parse_integer(name, value)); };
+			option.get = [field](const Configuration& configuration) { return std::to_string(configuration.*field); };
+		}
+		options.push_back(option);
+	}
+
+	/* `--population-size` and `population_size` are the same name */
+	static std::string normalize_name(std::string name)
+	{
+		std::replace(name.begin(), name.end(), '-', '_');
+		return name;
+	}
+
+	static std::string trim(const std::string& text)
+	{
+		const auto begin = text.find_first_not_of(" \t\r\n");
+		if (begin == std::string::npos)
+		{
+			return "";
+		}
+		const auto end = text.find_last_not_of(" \t\r\n");
+		return text.substr(begin, end - begin + 1);
+	}
+
+public:
+	ConfigurationParser()
+	{
+		add("random_seed", &Configuration::random_seed);
+		add("problem_filename", &Configuration::problem_filename);
+		add("solver_type", &Configuration::solver_type);
+		add("crossover_type", &Configuration::crossover_type);
+		add("selection_type", &Configuration::selection_type);
+		add("mutation_type", &Configuration::mutation_type);
+		add("decoder_type", &Configuration::decoder_type);
+		add("threads", &Configuration::threads);
+		add("time_limit", &Configuration::time_limit);
+		add("solution_filename", &Configuration::solution_filename);
+		add("improvements_filename", &Configuration::improvements_filename);
+		add("genetic_mode", &Configuration::genetic_mode);
+		add("tournament_size", &Configuration::tournament_size);
+		add("evaluations", &Configuration::evaluations);
+		add("population_size", &Configuration::population_size);
+		add("generations", &Configuration::generations);
+		add("mutation_probability", &Configuration::mutation_probability);
+		add("min_mutation_value", &Configuration::min_mutation_value);
+		add("max_mutation_value", &Configuration::max_mutation_value);
+		add("is_duplicate_elimination_enabled", &Configuration::is_duplicate_elimination_enabled);
+		add("heavy_mutation_value", &Configuration::heavy_mutation_value);
+		add("diversity_sample_size", &Configuration::diversity_sample_size);
+		add("fitness_cache_capacity", &Configuration::fitness_cache_capacity);
+		add("initial_temperature", &Configuration::initial_temperature);
+		add("final_temperature", &Configuration::final_temperature);
+		add("iterations", &Configuration::iterations);
+		add("cooling_schedule", &Configuration::cooling_schedule);
+		add("critical_move_probability", &Configuration::critical_move_probability);
+		add("move_evaluation", &Configuration::move_evaluation);
+		add("tempering_replicas", &Configuration::tempering_replicas);
+		add("tempering_exchange_interval", &Configuration::tempering_exchange_interval);
+		add("island_address", &Configuration::island_address);
+		add("islands", &Configuration::islands);
+		add("migration_interval", &Configuration::migration_interval);
+		add("migrants", &Configuration::migrants);
+		add("portfolio", &Configuration::portfolio);
+		add("portfolio_round_time", &Configuration::portfolio_round_time);
+		add("portfolio_rounds", &Configuration::portfolio_rounds);
+		add("batch", &Configuration::batch);
+		add("batch_results", &Configuration::batch_results);
+		add("batch_instance_threads", &Configuration::batch_instance_threads);
+		add("serve", &Configuration::serve);
+	}
+
+	/* throws on the unknown names and the values of the wrong type */
+	void set(Configuration& configuration, const std::string& name, const std::string& value) const
+	{
+		const std::string normalized_name = normalize_name(name);
+		for (const auto& option : options)
+		{
+			// the operators can be given without the `_type` suffix: `--crossover 1-point`
+			if (option.name == normalized_name || option.name == normalized_name + "_type")
+			{
+				option.set(configuration, value);
+				return;
+			}
+		}
+		throw std::runtime_error("Unknown option " + name + ", see --help.");
+	}
+
+	void load_file(Configuration& configuration, const std::string& filename) const
+	{
+		std::ifstream file(filename);
+		if (!file.is_open())
+		{
+			throw std::runtime_error("Failed to open the config file " + filename + ".");
+		}
+
+		std::string line;
+		int line_number{ 0 };
+		while (std::getline(file, line))
+		{
+			++line_number;
+			line = trim(line.substr(0, line.find_first_of("#;")));
+			if (line.empty() || line.front() == '[')
+			{
+				continue;
+			}
+			const auto equals = line.find('=');
+			if (equals == std::string::npos)
+			{
+				throw std::runtime_error(filename + ":" + std::to_string(line_number) + ": expected name = value.");
+			}
+			std::string value = trim(line.substr(equals + 1));
+			if (value.size() >= 2 && value.front() == '"' && value.back() == '"')
+			{
+				value = value.substr(1, value.size() - 2);
+			}
+			set(configuration, trim(line.substr(0, equals)), value);
+		}
+	}
+
+	/* returns false if the run should stop right away (`--help`) */
+	bool parse_command_line(Configuration& configuration, int argc, char* argv[]) const
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string argument = argv[i];
+			if (argument == "--help" || argument == "-h")
+			{
+				print_help(configuration);
+				return false;
+			}
+			if (argument.rfind("--", 0) != 0)
+			{
+				throw std::runtime_error("Unexpected argument " + argument + ", options start with --.");
+			}
+
+			std::string name;
+			std::string value;
+			const auto equals = argument.find('=');
+			if (equals != std::string::npos)
+			{
+				name = argument.substr(2, equals - 2);
+				value = argument.substr(equals + 1);
+			}
+			else
+			{
+				if (i + 1 >= argc)
+				{
+					throw std::runtime_error("Option " + argument + " needs a value.");
+				}
+				name = argument.substr(2);
+				value = argv[++i];
+			}
+
+			if (name == "config")
+			{
+				load_file(configuration, value);
+			}
+			else
+			{
+				set(configuration, name, value);
+			}
+		}
+		configuration.validate();
+		return true;
+	}
+
+	void print_help(const Configuration& configuration) const
+	{
+		std::cout << "Usage: main [--config file.ini] [--name value | --name=value]...\n"
+			<< "Options and their current values:\n";
+		for (const auto& option : options)
+		{
+			std::cout << "  --" << option.name << " " << option.get(configuration) << "\n";
+		}
+	}
+};
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+#include "common.h"
+
+/**
+* Memo of the repairs: what the decoder has already made out of a chromosome, and its total runtime.
+*
+* In a converged population most of the children are clones of their parents or of each other,
+* so most of the repairs in the late generations get the start times they got before.
+* The repair is a function of the start times it gets, so the key is the signature of the chromosome BEFORE the repair,
+* and the value is the repaired chromosome with its total runtime: a hit is exactly what the repair and the evaluation would give,
+* it skips `resolve_conflicts()`, `compact()` and the batch evaluation and changes nothing in the search.
+*
+* The table is bounded and direct-mapped: a new entry simply overwrites whatever was in its slot,
+* and the repaired chromosomes are stored in one block allocated once.
+* It's read-only while the workers repair, the GA inserts between the parallel loops in an order which doesn't depend on the threads,
+* so even the hit counts are the same for any number of threads.
+*/
+class FitnessCache
+{
+private:
+	int tasks_count;
+	uint64_t mask{ 0 };
+	std::vector<uint64_t> signatures; // 0 is an empty slot
+	std::vector<int> total_runtimes;
+	std::vector<int> schedules; // `tasks_count` start times per slot
+
+public:
+	/* `capacity` is rounded up to the power of 2, 0 makes a cache which is never looked up */
+	FitnessCache(int capacity, int tasks_count) : tasks_count(tasks_count)
+	{
+		if (capacity <= 0)
+		{
+			return;
+		}
+		size_t size = 1;
+		while (size < static_cast<size_t>(capacity))
+		{
+			size <<= 1;
+		}
+		mask = size - 1;
+		signatures.assign(size, 0);
+		total_runtimes.assign(size, 0);
+		schedules.assign(size * tasks_count, 0);
+	}
+
+	bool is_enabled() const
+	{
+		return !signatures.empty();
+	}
+
+	/* true if the chromosome with this signature was repaired before, then `schedule` and `total_runtime` are what it was repaired to; the cache must be enabled */
+	template <typename Gene>
+	bool find(uint64_t signature, BasicChromosome<Gene>& schedule, int& total_runtime) const
+	{
+		const size_t slot = signature & mask;
+		if (signatures[slot] != signature)
+		{
+			return false;
+		}
+		const int* stored = schedules.data() + slot * tasks_count;
+		schedule.assign(stored, stored + tasks_count);
+		total_runtime = total_runtimes[slot];
+		return true;
+	}
+
+	template <typename Gene>
+	void insert(uint64_t signature, const BasicChromosome<Gene>& schedule, int total_runtime)
+	{
+		const size_t slot = signature & mask;
+		signatures[slot] = signature;
+		total_runtimes[slot] = total_runtime;
+		std::copy(schedule.begin(), schedule.end(), schedules.begin() + slot * tasks_count);
+	}
+};
+
+/*
+ * Signature of the chromosome, the key of the `FitnessCache` and what tells the clones apart in the duplicate elimination.
+ * Never 0, that's an empty slot of the cache.
+ * Genes are hashed as 32-bit values, so the 16-bit and the 32-bit chromosomes of the same schedule get the same signature.
+ */
+template <typename Gene>
+inline uint64_t schedule_signature(const BasicChromosome<Gene>& start_times)
+{
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	for (const auto gene : start_times)
+	{
+		hash = (hash ^ static_cast<uint32_t>(gene)) * 0x100000001B3ULL;
+	}
+	// FNV alone has weak high bits for short inputs, and we use both halves of the signature
+	hash ^= hash >> 33;
+	hash *= 0xFF51AFD7ED558CCDULL;
+	hash ^= hash >> 33;
+	hash *= 0xC4CEB9FE1A85EC53ULL;
+	hash ^= hash >> 33;
+	return hash == 0 ? 1 : hash;
+}
+
+/*
+ * Inserts of one parallel loop, collected by the workers in whatever order they come and inserted all at once:
+ * sorted first, so the entry which stays in a contested slot is the same for any number of threads.
+ */
+struct PendingCacheInsert
+{
+	uint64_t signature;
+	int total_runtime;
+	Chromosome schedule;
+
+	bool operator<(const PendingCacheInsert& other) const
+	{
+		return std::tie(signature, total_runtime, schedule) < std::tie(other.signature, other.total_runtime, other.schedule);
+	}
+};
+
+inline void insert_pending(FitnessCache& cache, std::vector<PendingCacheInsert>& pending)
+{
+	std::sort(pending.begin(), pending.end());
+	for (const auto& insert : pending)
+	{
+		cache.insert(insert.signature, insert.schedule, insert.total_runtime);
+	}
+	pending.clear();
+}
+
+/*
+ * What the decoder knew of the chromosome it repaired last:
+ * its total runtime if the cache had it (-1 otherwise), and the key to insert it with once it's evaluated (0 if there's nothing to insert).
+ */
+struct RepairNote
+{
+	int known_total_runtime{ -1 };
+	uint64_t cache_key{ 0 };
+};
+
+/* the decoder's side of the `FitnessCache`: looks the chromosomes up before they are repaired, and counts the hits */
+struct RepairMemo
+{
+	const FitnessCache* cache{ nullptr }; // nullptr repairs everything
+	RepairNote note; // of the last repair
+	long long hits{ 0 };
+	long long lookups{ 0 };
+
+	/*
+	 * Starts the note of a new repair. True if the repair isn't needed, then `repaired` is what it would give.
+	 * A chromosome known to run longer than `runtime_bound` is left to the bounded repair, which gives up on it early enough.
+	 */
+	template <typename Gene>
+	bool find(const BasicChromosome<Gene>& start_times, BasicChromosome<Gene>& repaired, int runtime_bound)
+	{
+		note = RepairNote{};
+		if (cache == nullptr)
+		{
+			return false;
+		}
+		++lookups;
+		const uint64_t key = schedule_signature(start_times);
+		int total_runtime;
+		if (!cache->find(key, repaired, total_runtime))
+		{
+			note.cache_key = key;
+			return false;
+		}
+		if (total_runtime > runtime_bound)
+		{
+			return false;
+		}
+		++hits;
+		note.known_total_runtime = total_runtime;
+		return true;
+	}
+};
@@ -0,0 +1,361 @@
+#pragma once
+
+#include <array>
+
+#include "common.h"
+#include "BatchEvaluator.h"
+#include "FitnessCache.h"
+#include "SolutionTemplate.h"
+
+/**
+* The decoder specialised for one problem at compile time.
+*
+* `generate_instance` turns a problem file into a header with a `constexpr FixedInstance`:
+* the same tables as `PrecedenceGraph`, but in `std::array`s with the sizes known to the compiler.
+* `FixedSolutionTemplate` takes the sizes and the tables as template parameters,
+* so every loop of the repair and of the evaluation has a compile-time trip count and every lookup into the tables is a constant,
+* the compiler is free to unroll and vectorize as it likes.
+* `FixedBatchEvaluator` is the `BatchEvaluator` over the same tables, the GA takes it with the decoder (`Decoder::Evaluator`).
+*
+* It does exactly what `SolutionTemplate::resolve_conflicts()` and `compact()` do, with the same tie-breaking,
+* and the evaluator gives the same total runtimes as `BatchEvaluator`,
+* so a run with the fixed decoder follows the same trajectory as the one with the compacting decoder.
+*
+* To use it, build with `make fixed INSTANCE=la40seti5.txt` and run with `--decoder fixed`.
+*/
+template <int Jobs, int Machines, int Tasks>
+struct FixedInstance
+{
+	static constexpr int jobs_count = Jobs;
+	static constexpr int machines_count = Machines;
+	static constexpr int tasks_count = Tasks;
+
+	/* per task */
+	std::array<int, Tasks> lengths;
+	std::array<int, Tasks> job_of_task;
+	std::array<int, Tasks> machine_of_task;
+	std::array<int, Tasks> job_successor; // -1 if the task is the last in its job
+
+	/* CSR, same as in `PrecedenceGraph` */
+	std::array<int, Jobs + 1> job_offsets;
+	std::array<int, Tasks> job_tasks;
+	std::array<int, Machines + 1> machine_offsets;
+	std::array<int, Tasks> machine_tasks;
+
+	/* whether the problem loaded at runtime is the one we were compiled for */
+	bool matches(const PrecedenceGraph& graph) const
+	{
+		return graph.tasks_count() == Tasks && graph.jobs_count() == Jobs && graph.machines_count() == Machines
+			&& std::equal(lengths.begin(), lengths.end(), graph.lengths.begin())
+			&& std::equal(job_of_task.begin(), job_of_task.end(), graph.job_of_task.begin())
+			&& std::equal(machine_of_task.begin(), machine_of_task.end(), graph.machine_of_task.begin());
+	}
+};
+
+template <int Jobs, int Machines, int Tasks, const FixedInstance<Jobs, Machines, Tasks>& Instance>
+class FixedSolutionTemplate
+{
+private:
+	std::array<int, Tasks> start_times{};
+	std::array<int, Tasks> machine_order{ Instance.machine_tasks };
+
+	/*
+	 * Same ordering as `SolutionTemplate::sort_machine_by_start_times()`.
+	 * Machines are short and between the passes of `resolve_conflicts()` they are almost sorted already,
+	 * insertion sort is much cheaper than `std::sort` for that. The order is strict, so the result is the same.
+	 */
+	void sort_machine_by_start_times(int machine_id)
+	{
+		const int machine_begin = Instance.machine_offsets[machine_id];
+		const int machine_end = Instance.machine_offsets[machine_id + 1];
+		for (int i = machine_begin + 1; i < machine_end; ++i)
+		{
+			const int task_index = machine_order[i];
+			const int start_time = start_times[task_index];
+			int j = i;
+			for (; j > machine_begin; --j)
+			{
+				const int previous = machine_order[j - 1];
+				if (start_times[previous] < start_time || (start_times[previous] == start_time && previous < task_index))
+				{
+					break;
+				}
+				machine_order[j] = previous;
+			}
+			machine_order[j] = task_index;
+		}
+	}
+
+public:
+	template <typename Gene>
+	void fill_start_times(const BasicChromosome<Gene>& new_start_times)
+	{
+		if (new_start_times.size() != Tasks)
+		{
+			throw std::runtime_error("Numbers of start times in the chromosome must be the same as number of tasks in the fixed instance.");
+		}
+		std::copy_n(new_start_times.begin(), Tasks, start_times.begin());
+		for (int machine_id = 0; machine_id < Machines; ++machine_id)
+		{
+			sort_machine_by_start_times(machine_id);
+		}
+	}
+
+	/* see `SolutionTemplate::resolve_conflicts()` for the description */
+	bool resolve_conflicts(int runtime_bound)
+	{
+		bool had_collision;
+		do
+		{
+			had_collision = false;
+			for (int job_id = 0; job_id < Jobs; ++job_id)
+			{
+				const int job_end = Instance.job_offsets[job_id + 1];
+				for (int i = Instance.job_offsets[job_id]; i < job_end - 1; ++i)
+				{
+					const int left_task_index = Instance.job_tasks[i];
+					const int diff = start_times[left_task_index] + Instance.lengths[left_task_index] - start_times[Instance.job_tasks[i + 1]];
+					if (diff > 0)
+					{
+						had_collision = true;
+						for (int j = i + 1; j < job_end; ++j)
+						{
+							start_times[Instance.job_tasks[j]] += diff;
+						}
+						const int last_task_index = Instance.job_tasks[job_end - 1];
+						if (start_times[last_task_index] + Instance.lengths[last_task_index] > runtime_bound)
+						{
+							return false;
+						}
+					}
+				}
+			}
+
+			for (int machine_id = 0; machine_id < Machines; ++machine_id)
+			{
+				sort_machine_by_start_times(machine_id);
+
+				const int machine_end = Instance.machine_offsets[machine_id + 1];
+				for (int i = Instance.machine_offsets[machine_id]; i < machine_end - 1; ++i)
+				{
+					const int left_task_index = machine_order[i];
+					const int diff = start_times[left_task_index] + Instance.lengths[left_task_index] - start_times[machine_order[i + 1]];
+					if (diff > 0)
+					{
+						had_collision = true;
+						for (int j = i + 1; j < machine_end; ++j)
+						{
+							start_times[machine_order[j]] += diff;
+						}
+						const int last_task_index = machine_order[machine_end - 1];
+						if (start_times[last_task_index] + Instance.lengths[last_task_index] > runtime_bound)
+						{
+							return false;
+						}
+					}
+				}
+			}
+		} while (had_collision);
+		return true;
+	}
+
+	/* see `SolutionTemplate::compact()` for the description */
+	bool compact(int runtime_bound)
+	{
+		std::array<int, Tasks> processing_order;
+		for (int i = 0; i < Tasks; ++i)
+		{
+			processing_order[i] = i;
+		}
+		// (start time, index) is a strict order, so this is the same as the stable sort by the start time
+		std::sort(processing_order.begin(), processing_order.end(), [this](int a, int b) {
+			return start_times[a] < start_times[b] || (start_times[a] == start_times[b] && a < b);
+			});
+
+		std::array<int, Jobs> job_ready_times{};
+		std::array<int, Machines> placed_on_machine{};
+
+		for (const auto task_index : processing_order)
+		{
+			const int job_id = Instance.job_of_task[task_index];
+			const int machine_id = Instance.machine_of_task[task_index];
+			const int length = Instance.lengths[task_index];
+			const int machine_begin = Instance.machine_offsets[machine_id];
+			const int machine_end = machine_begin + placed_on_machine[machine_id];
+
+			int gap_start = 0;
+			int insert_position = machine_begin;
+			for (; insert_position < machine_end; ++insert_position)
+			{
+				const int next_task_index = machine_order[insert_position];
+				if (std::max(gap_start, job_ready_times[job_id]) + length <= start_times[next_task_index])
+				{
+					break;
+				}
+				gap_start = start_times[next_task_index] + Instance.lengths[next_task_index];
+			}
+
+			start_times[task_index] = std::max(gap_start, job_ready_times[job_id]);
+			std::copy_backward(machine_order.begin() + insert_position, machine_order.begin() + machine_end, machine_order.begin() + machine_end + 1);
+			machine_order[insert_position] = task_index;
+			++placed_on_machine[machine_id];
+			job_ready_times[job_id] = start_times[task_index] + length;
+			if (job_ready_times[job_id] > runtime_bound)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template <typename Gene>
+	void get_chromosome(BasicChromosome<Gene>& result) const
+	{
+		result.assign(start_times.begin(), start_times.end());
+	}
+
+	/* the machine ranges must be in the timeline order, same as for `SolutionTemplate::total_runtime()` */
+	int total_runtime() const
+	{
+		int max_time{ 0 };
+		for (int machine_id = 0; machine_id < Machines; ++machine_id)
+		{
+			const int last_task_index = machine_order[Instance.machine_offsets[machine_id + 1] - 1];
+			max_time = std::max(max_time, start_times[last_task_index] + Instance.lengths[last_task_index]);
+		}
+		return max_time;
+	}
+};
+
+/**
+* `BatchEvaluator` over the fixed tables, same interface and same results.
+* The jobs are walked in the CSR order, so a task's start is final before it's pushed along to its job successor,
+* and the whole evaluation is one loop over `Tasks`.
+*/
+template <int Jobs, int Machines, int Tasks, const FixedInstance<Jobs, Machines, Tasks>& Instance>
+class FixedBatchEvaluator
+{
+private:
+	std::vector<int> tile;
+	int lanes_used{ 0 };
+
+public:
+	/* the graph is the one `FixedDecoder` has already checked against the instance */
+	explicit FixedBatchEvaluator(const PrecedenceGraph&) : tile(static_cast<size_t>(Tasks) * BATCH_LANES, 0) {}
+
+	bool is_full() const
+	{
+		return lanes_used == BATCH_LANES;
+	}
+
+	int size() const
+	{
+		return lanes_used;
+	}
+
+	template <typename Gene>
+	void add(const BasicChromosome<Gene>& start_times)
+	{
+		const int lane = lanes_used++;
+		for (int task_index = 0; task_index < Tasks; ++task_index)
+		{
+			tile[task_index * BATCH_LANES + lane] = start_times[task_index];
+		}
+	}
+
+	/* see `BatchEvaluator::evaluate()` */
+	NEC_TARGET_CLONES void evaluate(int* total_runtimes)
+	{
+		int result[BATCH_LANES] = {};
+
+		for (int i = 0; i < Tasks; ++i)
+		{
+			const int task_index = Instance.job_tasks[i];
+			const int successor = Instance.job_successor[task_index];
+			const int length = Instance.lengths[task_index];
+			const int* starts = tile.data() + task_index * BATCH_LANES;
+			if (successor >= 0)
+			{
+				int* successor_starts = tile.data() + successor * BATCH_LANES;
+				for (int lane = 0; lane < BATCH_LANES; ++lane)
+				{
+					successor_starts[lane] = std::max(successor_starts[lane], starts[lane] + length);
+				}
+			}
+			else
+			{
+				for (int lane = 0; lane < BATCH_LANES; ++lane)
+				{
+					result[lane] = std::max(result[lane], starts[lane] + length);
+				}
+			}
+		}
+
+		std::copy(result, result + lanes_used, total_runtimes);
+		lanes_used = 0;
+	}
+};
+
+/**
+* Decoder policy of the GA over the fixed template, same interface as `RepairDecoder`.
+* The runtime `SolutionTemplate` is still there for everything outside the repair and the evaluation (bounds, printing, migrations).
+*/
+template <int Jobs, int Machines, int Tasks, const FixedInstance<Jobs, Machines, Tasks>& Instance>
+class FixedDecoder
+{
+private:
+	SolutionTemplate& solution_template;
+	FixedSolutionTemplate<Jobs, Machines, Tasks, Instance> fixed_template;
+	int runtime_bound{ std::numeric_limits<int>::max() };
+
+public:
+	RepairMemo memo; // see `RepairDecoder`
+
+	static constexpr auto name = "fixed";
+	static constexpr bool is_compacting = true;
+	typedef FixedBatchEvaluator<Jobs, Machines, Tasks, Instance> Evaluator;
+
+	explicit FixedDecoder(SolutionTemplate& solution_template) : solution_template(solution_template)
+	{
+		check_instance(solution_template);
+	}
+
+	/* throws if the problem of the template isn't the one the decoder was generated for */
+	static void check_instance(const SolutionTemplate& solution_template)
+	{
+		if (!Instance.matches(solution_template.get_graph()))
+		{
+			throw std::runtime_error("The problem file is not the instance the fixed decoder was generated for.");
+		}
+	}
+
+	SolutionTemplate& get_template()
+	{
+		return solution_template;
+	}
+
+	/* see `RepairDecoder::set_runtime_bound()` */
+	void set_runtime_bound(int bound)
+	{
+		runtime_bound = bound;
+	}
+
+	template <typename Gene>
+	BasicChromosome<Gene> repair(const BasicChromosome<Gene>& start_times)
+	{
+		BasicChromosome<Gene> result;
+		if (memo.find(start_times, result, runtime_bound))
+		{
+			return result;
+		}
+		fixed_template.fill_start_times(start_times);
+		// as in `RepairDecoder`, only the compaction can be cut short
+		fixed_template.resolve_conflicts(std::numeric_limits<int>::max());
+		if (!fixed_template.compact(runtime_bound))
+		{
+			return {};
+		}
+		fixed_template.get_chromosome(result);
+		return result;
+	}
+};
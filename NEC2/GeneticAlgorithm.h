@@ -0,0 +1,1715 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <iomanip>
+#include <iterator>
+#include <memory>
+#include <semaphore>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_set>
+
+#include "common.h"
+#include "Random.h"
+#include "Kernels.h"
+#include "SolutionTemplate.h"
+#include "BatchEvaluator.h"
+#include "FitnessCache.h"
+#include "ConcurrentQueue.h"
+#include "TaskScheduler.h"
+
+/**
+* The genetic algorithm over start times, built out of policies.
+*
+* Crossover, mutation, selection and the decoder (how a chromosome is repaired) are types, not strings,
+* so every configuration is its own instantiation of `solve_using_genetic_algorithm` with all the operators inlined into the hot loop,
+* instead of comparing `const char*` settings for every pair and every mutation.
+*
+* To keep the configuration selectable at runtime, all the combinations are instantiated once
+* and put into the registry (see `genetic_solvers()`), where they are looked up by the names of the policies.
+*
+* Every policy has a `name` which is the same string as we used in the settings before.
+*/
+
+/*
+ * How the population is replaced:
+ * - Generational: the better half breeds and the offspring replace the worse half, all at once, then everything is sorted
+ * - SteadyState: one pair of offspring at a time from the tournament winners, each of them replaces the worst specimen if it's better
+ * - Asynchronous: same as SteadyState, but the pairs are bred by the worker threads and replaced as they come
+ * - Pipelined: Generational, but each block of pairs is bred, mutated, evaluated and sorted in one go, then the blocks are merged
+ */
+enum class GeneticMode
+{
+	Generational,
+	SteadyState,
+	Asynchronous,
+	Pipelined,
+};
+
+/*
+ * Where an island of the multi-process GA sends its best specimens and gets the other islands' from, see Island.h.
+ * Migrants travel as plain `Chromosome`s, whatever the gene type of the island.
+ */
+class MigrationLink
+{
+public:
+	virtual ~MigrationLink() = default;
+
+	/* sends the emigrants and the best total runtime of this island, returns the immigrants, maybe none */
+	virtual std::vector<Chromosome> exchange(const std::vector<Chromosome>& emigrants, int best_total_runtime) = 0;
+};
+
+/* numeric settings of the GA, the policies are chosen by the types */
+struct GeneticSettings
+{
+	GeneticMode mode;
+	int population_size;
+	int generations;
+	int mutation_probability; // in percents
+	int min_mutation_value;
+	int max_mutation_value;
+	bool is_duplicate_elimination_enabled; // whether we replace the duplicate schedules with heavily mutated copies
+	int heavy_mutation_value; // every start time of the duplicate is moved by up to this value in both directions
+	int diversity_sample_size; // specimens compared pairwise for the diversity in the progress output
+	int fitness_cache_capacity; // repairs remembered by the fitness cache, 0 means no cache
+	double time_limit; // in seconds, 0 means no limit, checked once per generation
+	int threads; // number of the worker threads
+	int tournament_size; // steady state only, number of random specimens competing to become a parent
+	long long evaluations; // steady state only, number of offspring to evaluate, 0 means as many as `generations` of the generational mode would
+	MigrationLink* migration_link; // generational modes only, nullptr unless the run is an island of the multi-process GA
+	int migration_interval; // generations between the migrations
+	int migrants_count; // best specimens sent away on every migration
+	bool is_quiet; // no progress output and no final report, for the runs side by side in the portfolio or the batch
+	TaskScheduler* scheduler; // generational modes only, the pool to run on, nullptr means the run starts its own with `threads` threads
+	ImprovementListener* improvement_listener; // nullptr unless somebody wants every new best schedule as soon as it's found
+};
+
+/* tells the listener of the settings (there must be one) about the new best schedule, the genes are widened for it */
+template <typename Gene>
+void publish_improvement(const GeneticSettings& settings, const BasicChromosome<Gene>& best, int total_runtime)
+{
+	settings.improvement_listener->improved(Chromosome(best.begin(), best.end()), total_runtime);
+}
+
+/* -------- decoders -------- */
+
+/**
+* Turns any chromosome produced by the operators into a valid one.
+* Conflicts are resolved by pushing the tasks later, then (optionally) everything is pulled back as early as possible,
+* so every evaluation scores the best schedule its order of tasks on machines allows.
+* Given a fitness cache, the repair looks the chromosome up there first and doesn't repair it again if it's there.
+*/
+template <bool IsCompacting>
+class RepairDecoder
+{
+private:
+	SolutionTemplate& solution_template;
+	int runtime_bound{ std::numeric_limits<int>::max() };
+
+public:
+	RepairMemo memo; // the GA gives it the fitness cache and takes the notes
+
+	static constexpr auto name = IsCompacting ? "compacting" : "push-later";
+	static constexpr bool is_compacting = IsCompacting;
+	/* what the GA measures the repaired chromosomes with */
+	typedef BatchEvaluator Evaluator;
+
+	explicit RepairDecoder(SolutionTemplate& solution_template) : solution_template(solution_template) {}
+
+	SolutionTemplate& get_template()
+	{
+		return solution_template;
+	}
+
+	/*
+	 * The repairs from now on give up as soon as the schedule is known to run longer than `bound`,
+	 * and return an empty chromosome instead: the child is rejected without finishing the repair.
+	 * Only the repair which makes the final child may be bounded, an intermediate one (a crossover child to be mutated) must not.
+	 */
+	void set_runtime_bound(int bound)
+	{
+		runtime_bound = bound;
+	}
+
+	template <typename Gene>
+	BasicChromosome<Gene> repair(const BasicChromosome<Gene>& start_times)
+	{
+		BasicChromosome<Gene> repaired;
+		if (memo.find(start_times, repaired, runtime_bound))
+		{
+			return repaired;
+		}
+		solution_template.fill_start_times(start_times);
+		if constexpr (IsCompacting)
+		{
+			// the compaction can make the schedule shorter again, so only the compaction itself can be cut short
+			solution_template.resolve_conflicts();
+			if (!solution_template.compact(runtime_bound))
+			{
+				return {};
+			}
+		}
+		else
+		{
+			if (!solution_template.resolve_conflicts(runtime_bound))
+			{
+				return {};
+			}
+		}
+		return solution_template.get_chromosome<Gene>();
+	}
+};
+
+typedef RepairDecoder<true> CompactingDecoder;
+typedef RepairDecoder<false> PushLaterDecoder;
+
+/**
+* The compacting decoder for one big schedule at a time: the conflict resolution runs on the threads of the scheduler
+* (see `SolutionTemplate::resolve_conflicts(TaskScheduler&)`), the compaction stays sequential.
+* Same results as `CompactingDecoder`.
+*
+* It's only used for the starting schedule of the local search in a plain run, the one place which repairs a single schedule and waits for it
+* (the batch and the server use `CompactingDecoder` there). It's not one of the GA policies and the per-child repairs stay sequential:
+* they run inside the parallel loops over the population, which already keep all the threads busy, and `TaskScheduler::parallel_for` can't be nested.
+* Below `PARALLEL_DECODING_MIN_TASKS` it repairs on the calling thread, the barriers would cost more than the passes.
+* Even at 2000 tasks a sequential resolution takes about 0.3 ms, so don't expect more than a small part of that back.
+*/
+class ParallelDecoder
+{
+private:
+	SolutionTemplate& solution_template;
+	TaskScheduler& scheduler;
+	const bool is_parallel;
+
+public:
+	static constexpr auto name = "parallel";
+	static constexpr bool is_compacting = true;
+	static constexpr int PARALLEL_DECODING_MIN_TASKS = 1000;
+
+	ParallelDecoder(SolutionTemplate& solution_template, TaskScheduler& scheduler)
+		: solution_template(solution_template), scheduler(scheduler),
+		is_parallel(scheduler.threads_count() > 1 && solution_template.get_graph().tasks_count() >= PARALLEL_DECODING_MIN_TASKS)
+	{
+	}
+
+	SolutionTemplate& get_template()
+	{
+		return solution_template;
+	}
+
+	template <typename Gene>
+	BasicChromosome<Gene> repair(const BasicChromosome<Gene>& start_times)
+	{
+		solution_template.fill_start_times(start_times);
+		if (is_parallel)
+		{
+			solution_template.resolve_conflicts(scheduler);
+		}
+		else
+		{
+			solution_template.resolve_conflicts();
+		}
+		solution_template.compact();
+		return solution_template.get_chromosome<Gene>();
+	}
+};
+
+/* -------- crossovers -------- */
+
+/*
+ * The crossovers give the children back as they are, not repaired:
+ * each child is repaired by `finish_child()` with the bound of its own last repair.
+ */
+
+/*
+* 1-point crossover between two vectors.
+* Min size of both vectors is 3.
+*/
+struct OnePointCrossover
+{
+	static constexpr auto name = "1-point";
+
+	template <typename Gene>
+	static std::pair<BasicChromosome<Gene>, BasicChromosome<Gene>> apply(const BasicChromosome<Gene>& left, const BasicChromosome<Gene>& right, CounterRandom& random_engine)
+	{
+		if (left.size() != right.size())
+		{
+			throw std::runtime_error("Chromosomes must be of the same length.");
+		}
+		if (left.size() < 3)
+		{
+			throw std::runtime_error("Chromosomes must have at least 3 elements.");
+		}
+
+		int crossover_point = random_between(random_engine, 1, left.size() - 2);
+
+		BasicChromosome<Gene> offspring1{ left };
+		BasicChromosome<Gene> offspring2{ right };
+
+		simd_swap_ranges(offspring1.data(), offspring2.data(), crossover_point);
+
+		return std::make_pair(offspring1, offspring2);
+	}
+};
+
+/*
+* 2-point crossover between two vectors.
+* Min size of both vectors is 3.
+* We never swap the first element.
+*/
+struct TwoPointCrossover
+{
+	static constexpr auto name = "2-point";
+
+	template <typename Gene>
+	static std::pair<BasicChromosome<Gene>, BasicChromosome<Gene>> apply(const BasicChromosome<Gene>& left, const BasicChromosome<Gene>& right, CounterRandom& random_engine)
+	{
+		if (left.size() != right.size())
+		{
+			throw std::runtime_error("Chromosomes must be of the same length.");
+		}
+		if (left.size() < 3)
+		{
+			throw std::runtime_error("Chromosomes must have at least 3 elements.");
+		}
+
+		int point1 = random_between(random_engine, 1, left.size() - 2);
+		int point2 = random_between(random_engine, 1, left.size() - 2);
+
+		if (point1 > point2)
+		{
+			std::swap(point1, point2);
+		}
+		if (point1 == point2)
+		{
+			point2++;
+		}
+
+		BasicChromosome<Gene> offspring1{ left };
+		BasicChromosome<Gene> offspring2{ right };
+
+		// swap_ranges doesn't compile in VS 2022, so we use our own SIMD kernel instead
+		simd_swap_ranges(offspring1.data() + point1, offspring2.data() + point1, point2 - point1);
+
+		return std::make_pair(offspring1, offspring2);
+	}
+};
+
+/*
+* Uniform crossover between two vectors.
+* Every gene is taken from one of the parents with the probability of 50%, the second offspring gets the other parent's gene.
+*/
+struct UniformCrossover
+{
+	static constexpr auto name = "uniform";
+
+	template <typename Gene>
+	static std::pair<BasicChromosome<Gene>, BasicChromosome<Gene>> apply(const BasicChromosome<Gene>& left, const BasicChromosome<Gene>& right, CounterRandom& random_engine)
+	{
+		if (left.size() != right.size())
+		{
+			throw std::runtime_error("Chromosomes must be of the same length.");
+		}
+
+		std::vector<char> mask(left.size());
+		fill_mask(random_engine, mask, 50);
+
+		BasicChromosome<Gene> offspring1(left.size());
+		BasicChromosome<Gene> offspring2(left.size());
+		simd_blend(left.data(), right.data(), mask.data(), offspring1.data(), offspring2.data(), left.size());
+
+		return std::make_pair(offspring1, offspring2);
+	}
+};
+
+/* -------- mutations -------- */
+
+/**
+* Returns the NEW chromosome with one of the start times mutated.
+* There's randomness both in the position of the mutation and the value of the mutation.
+*/
+struct SingularMutation
+{
+	static constexpr auto name = "singular";
+
+	template <typename Gene, class Decoder>
+	static BasicChromosome<Gene> apply(const BasicChromosome<Gene>& input, CounterRandom& random_engine, Decoder& decoder, const GeneticSettings& settings)
+	{
+		auto position = random_below(random_engine, input.size());
+		auto mutation_value = random_between(random_engine, settings.min_mutation_value, settings.max_mutation_value);
+
+		BasicChromosome<Gene> result{ input };
+		result[position] += mutation_value;
+
+		// if mutation goes below 0, we need to correct it
+		if (result[position] < 0)
+		{
+			// we replace the mutation value with the absolute value of the mutation
+			result[position] -= mutation_value * 2;
+		}
+
+		return decoder.repair(result);
+	}
+};
+
+/**
+* Returns the NEW chromosome with one of the start times mutated.
+* This variant of mutation does XOR 1 to every element of the chromosome.
+* This introduces a lot of randomness and is not guaranteed to be feasible.
+*/
+struct XorMutation
+{
+	static constexpr auto name = "uniform XOR";
+
+	template <typename Gene, class Decoder>
+	static BasicChromosome<Gene> apply(const BasicChromosome<Gene>& input, CounterRandom&, Decoder& decoder, const GeneticSettings&)
+	{
+		BasicChromosome<Gene> result{ input };
+		simd_xor(result.data(), result.size(), 1);
+
+		return decoder.repair(result);
+	}
+};
+
+/**
+* Returns the NEW chromosome with every start time moved by a random value between the min and the max mutation value.
+* Same as `SingularMutation` but for all the genes at once, including the correction for the values going below 0.
+*/
+struct AdditiveMutation
+{
+	static constexpr auto name = "uniform additive";
+
+	template <typename Gene, class Decoder>
+	static BasicChromosome<Gene> apply(const BasicChromosome<Gene>& input, CounterRandom& random_engine, Decoder& decoder, const GeneticSettings& settings)
+	{
+		BasicChromosome<Gene> deltas(input.size());
+		fill_between(random_engine, deltas, settings.min_mutation_value, settings.max_mutation_value);
+
+		BasicChromosome<Gene> result{ input };
+		simd_add_reflected(result.data(), deltas.data(), result.size());
+
+		return decoder.repair(result);
+	}
+};
+
+/**
+* Returns the NEW chromosome far enough from the input to not be its clone anymore.
+* Same as `AdditiveMutation` but with the heavy mutation value, used to replace the duplicates.
+*/
+template <typename Gene, class Decoder>
+BasicChromosome<Gene> mutate_heavily(const BasicChromosome<Gene>& input, CounterRandom& random_engine, Decoder& decoder, const GeneticSettings& settings)
+{
+	BasicChromosome<Gene> deltas(input.size());
+	fill_between(random_engine, deltas, -settings.heavy_mutation_value, settings.heavy_mutation_value);
+
+	BasicChromosome<Gene> result{ input };
+	simd_add_reflected(result.data(), deltas.data(), result.size());
+
+	return decoder.repair(result);
+}
+
+/* -------- selections -------- */
+
+/*
+ * The selections get the sorted population and the number of the evaluated specimens at its front,
+ * the rest are the places of the rejected children (see `solve_using_genetic_algorithm()`).
+ */
+
+/* the better half of the population breeds, as is */
+struct PureSelection
+{
+	static constexpr auto name = "pure";
+
+	template <typename Gene>
+	static void before_breeding(BasicPopulation<Gene>&, int)
+	{
+	}
+};
+
+/* same, but the worst evaluated specimen is put into the half of the population allowed to breed */
+struct TaintedSelection
+{
+	static constexpr auto name = "tainted";
+
+	template <typename Gene>
+	static void before_breeding(BasicPopulation<Gene>& population, int evaluated_count)
+	{
+		std::swap(population[population.size() / 2 - 1], population[evaluated_count - 1]);
+	}
+};
+
+/**
+* Makes the final child out of a crossover child: the repair, then the mutation if `is_mutated`.
+* Only the last repair of the child is bounded by `runtime_bound`, the one of the mutation if there is one,
+* and the child comes back empty if it turns out to run longer than that.
+* The mutation takes its numbers from `mutation_random_engine`.
+*/
+template <class Mutation, typename Gene, class Decoder>
+BasicChromosome<Gene> finish_child(const BasicChromosome<Gene>& crossed, bool is_mutated, CounterRandom& mutation_random_engine,
+	Decoder& decoder, const GeneticSettings& settings, int runtime_bound)
+{
+	decoder.set_runtime_bound(is_mutated ? std::numeric_limits<int>::max() : runtime_bound);
+	BasicChromosome<Gene> child = decoder.repair(crossed);
+	if (is_mutated)
+	{
+		decoder.set_runtime_bound(runtime_bound);
+		child = Mutation::apply(child, mutation_random_engine, decoder, settings);
+	}
+	decoder.set_runtime_bound(std::numeric_limits<int>::max());
+	return child;
+}
+
+/* -------- the algorithm -------- */
+
+/*
+ * make a chromosome
+ *
+ * we cannot just make a random array of ints
+ * every int is a starting time of the task
+ * we need to apply the same conflict resolution algorithm to the chromosome
+ * also we need to allow chromosomes where starting time of non-conflicting tasks may overlap,
+ * because it's allowed and it's a whole point of parallelism through machines.
+*/
+template <typename Gene, class Decoder>
+BasicChromosome<Gene> make_chromosome(CounterRandom& random_engine, Decoder& decoder)
+{
+	SolutionTemplate& solution_template = decoder.get_template();
+
+	// get the chromosome of the correct length
+	BasicChromosome<Gene> raw = solution_template.template get_chromosome<Gene>();
+
+	// 1. fill the chromosome with random numbers between 0 and an absolute lowest bound
+	// Initial design was using half of horizon but with a lot of tasks (around 150) the difference between the lowest bound and the horizon is very large (x10 large)
+	// and the conflict resolution always "spreads" the tasks in time, so it's better to start with the lesser value
+	fill_between(random_engine, raw, 0, solution_template.absolute_lowest_bound());
+
+	// 2. put the randomized chromosome back into the solution template, resolve conflicts and get the clean chromosome back
+	return decoder.repair(raw);
+}
+
+/*
+ * Diversity of the first `count` specimens of the population for the progress output:
+ * - number of unique schedules among them,
+ * - mean pairwise distance between the machine orders of `sample_size` specimens spread over them,
+ *   which is the share of the positions on the machines holding different tasks, 0 for the clones.
+ */
+template <typename Gene>
+std::pair<int, double> measure_diversity(SolutionTemplate& solution_template, const BasicPopulation<Gene>& population, int count, int sample_size)
+{
+	std::unordered_set<uint64_t> signatures;
+	for (int i = 0; i < count; ++i)
+	{
+		signatures.insert(schedule_signature(std::get<0>(population[i])));
+	}
+
+	sample_size = std::min(sample_size, count);
+	std::vector<std::vector<int>> machine_orders;
+	for (int i = 0; i < sample_size; ++i)
+	{
+		solution_template.fill_start_times(std::get<0>(population[i * count / sample_size]));
+		machine_orders.push_back(solution_template.get_machine_order());
+	}
+
+	double total_distance{ 0.0 };
+	int pairs_count{ 0 };
+	for (int i = 0; i < sample_size; ++i)
+	{
+		for (int j = i + 1; j < sample_size; ++j)
+		{
+			int different_positions{ 0 };
+			for (size_t position = 0; position < machine_orders[i].size(); ++position)
+			{
+				different_positions += machine_orders[i][position] != machine_orders[j][position];
+			}
+			total_distance += static_cast<double>(different_positions) / machine_orders[i].size();
+			++pairs_count;
+		}
+	}
+
+	return { static_cast<int>(signatures.size()), pairs_count == 0 ? 0.0 : total_distance / pairs_count };
+}
+
+/*
+ * Merges the sorted runs [bounds[i], bounds[i + 1]) into one sorted range, pairs of neighbouring runs at a time,
+ * all the pairs of one round in parallel. The merge is stable, so the result is the stable sort of the whole range.
+ */
+template <typename Specimen, typename Compare>
+void merge_sorted_runs(TaskScheduler& scheduler, std::vector<Specimen>& specimens, std::vector<int> bounds, Compare compare)
+{
+	while (bounds.size() > 2)
+	{
+		const int merges_count = static_cast<int>(bounds.size() - 1) / 2;
+		scheduler.parallel_for(merges_count, 1, [&](int begin, int end, int) {
+			for (int merge = begin; merge < end; ++merge)
+			{
+				std::inplace_merge(specimens.begin() + bounds[2 * merge], specimens.begin() + bounds[2 * merge + 1],
+					specimens.begin() + bounds[2 * merge + 2], compare);
+			}
+			});
+
+		// every other bound is gone now, the last one stays whatever the count
+		std::vector<int> merged_bounds;
+		for (size_t i = 0; i < bounds.size(); i += 2)
+		{
+			merged_bounds.push_back(bounds[i]);
+		}
+		if (merged_bounds.back() != bounds.back())
+		{
+			merged_bounds.push_back(bounds.back());
+		}
+		bounds.swap(merged_bounds);
+	}
+}
+
+/* what one worker of `solve_using_genetic_algorithm()` needs for itself: the decoder works in its own solution template */
+template <class Decoder>
+struct GeneticWorker
+{
+	SolutionTemplate solution_template;
+	Decoder decoder;
+	typename Decoder::Evaluator batch_evaluator;
+	size_t batch_indices[BATCH_LANES];
+	long long aborted_repairs{ 0 }; // children rejected by the bound before their repair was finished
+	std::vector<PendingCacheInsert> pending_inserts; // the schedules this worker evaluated, for the fitness cache
+
+	explicit GeneticWorker(const SolutionTemplate& original)
+		: solution_template(original), decoder(solution_template), batch_evaluator(solution_template.get_graph())
+	{
+	}
+};
+
+/*
+ * Every random decision of the GA takes its numbers from a counter-based generator keyed by
+ * (seed, generation, specimen index, operator), so the search trajectory depends only on the seed.
+ *
+ * The initialisation, the evaluation, the breeding and the mutation are loops over independent specimens,
+ * they run on the work-stealing scheduler with `settings.threads` workers. Since no random number depends on
+ * which worker takes which specimen, the trajectory is the same for any number of threads.
+ * Only the elimination of duplicates, which depends on the order of the specimens, stays sequential.
+ */
+template <class Crossover, class Selection, class Mutation, class Decoder, typename Gene>
+BasicSpecimen<Gene> solve_using_genetic_algorithm(SolutionTemplate& solution_template, const GeneticSettings& settings, uint64_t seed)
+{
+	const int population_size = settings.population_size;
+	// chunks of the parallel loops: small enough to balance, big enough to fill the batches of the evaluator
+	const int specimens_grain = 4 * BATCH_LANES;
+	const int pairs_grain = 8;
+	const bool is_pipelined = settings.mode == GeneticMode::Pipelined;
+
+	const Deadline deadline(settings.time_limit);
+
+	// everything sized by the settings is allocated here once, the generations only reuse it
+	// the server keeps its pool between the requests, so the threads are already there
+	std::unique_ptr<TaskScheduler> own_scheduler;
+	if (settings.scheduler == nullptr)
+	{
+		own_scheduler = std::make_unique<TaskScheduler>(settings.threads);
+	}
+	TaskScheduler& scheduler = settings.scheduler != nullptr ? *settings.scheduler : *own_scheduler;
+	// the workers hold references into themselves, they must never move
+	std::vector<std::unique_ptr<GeneticWorker<Decoder>>> workers;
+	for (int i = 0; i < scheduler.threads_count(); ++i)
+	{
+		workers.push_back(std::make_unique<GeneticWorker<Decoder>>(solution_template));
+	}
+	Decoder& decoder = workers[0]->decoder;
+	BasicPopulation<Gene> population(population_size);
+	std::vector<char> mutation_mask(population_size);
+	std::unordered_set<uint64_t> population_signatures;
+	int duplicates_replaced{ 0 };
+	// what the decoder knew of the specimen in every slot when it was born, until it's evaluated
+	std::vector<RepairNote> repair_notes(population_size);
+	FitnessCache fitness_cache(settings.fitness_cache_capacity, solution_template.get_graph().tasks_count());
+	if (fitness_cache.is_enabled())
+	{
+		for (auto& worker : workers)
+		{
+			worker->decoder.memo.cache = &fitness_cache;
+		}
+	}
+	std::vector<PendingCacheInsert> pending_inserts;
+	// hits and lookups of all the workers so far
+	auto count_cache = [&]() {
+		std::pair<long long, long long> counts{ 0, 0 };
+		for (const auto& worker : workers)
+		{
+			counts.first += worker->decoder.memo.hits;
+			counts.second += worker->decoder.memo.lookups;
+		}
+		return counts;
+	};
+	// the runtime of the worst survivor of the generation, see the breeding below
+	int runtime_bound{ std::numeric_limits<int>::max() };
+	// the birth of a rejected child: a copy of its parent holds its place until the children of the next generation replace it,
+	// it's never evaluated, selected or taken for a duplicate, and with the lowest fitness possible it sorts after every evaluated specimen
+	constexpr int REJECTED_BIRTH = -1;
+	constexpr Fitness REJECTED_FITNESS = std::numeric_limits<Fitness>::lowest();
+	auto is_evaluated = [](const BasicSpecimen<Gene>& specimen) {
+		return std::get<2>(specimen) != REJECTED_BIRTH;
+	};
+
+	// generate the initial population
+	scheduler.parallel_for(population_size, specimens_grain, [&](int begin, int end, int worker_id) {
+		for (int i = begin; i < end; ++i)
+		{
+			CounterRandom random_engine(seed, 0, i, RandomStream::Initialisation);
+			population[i] = { make_chromosome<Gene>(random_engine, workers[worker_id]->decoder), 0, 0 };
+			repair_notes[i] = workers[worker_id]->decoder.memo.note;
+		}
+		});
+
+	auto is_fitter = [](const BasicSpecimen<Gene>& a, const BasicSpecimen<Gene>& b) {
+		return std::get<1>(a) > std::get<1>(b);
+	};
+
+	// calculate the fitness of each chromosome born in `birth`, BATCH_LANES chromosomes at once
+	// don't need to resolve conflicts as all our operators do it
+	// the ones the fitness cache knew already have their runtimes, the rest go to the cache once they are evaluated
+	auto evaluate_newborn = [&](int begin, int end, int worker_id, int birth) {
+		GeneticWorker<Decoder>& worker = *workers[worker_id];
+		auto flush_batch = [&]() {
+			int total_runtimes[BATCH_LANES];
+			const int batch_size = worker.batch_evaluator.size();
+			worker.batch_evaluator.evaluate(total_runtimes);
+			for (int lane = 0; lane < batch_size; ++lane)
+			{
+				const size_t i = worker.batch_indices[lane];
+				std::get<1>(population[i]) = solution_template.fitness_of_runtime(total_runtimes[lane]);
+				if (repair_notes[i].cache_key != 0)
+				{
+					const auto& chromosome = std::get<0>(population[i]);
+					worker.pending_inserts.push_back({ repair_notes[i].cache_key, total_runtimes[lane], Chromosome(chromosome.begin(), chromosome.end()) });
+				}
+				repair_notes[i] = RepairNote{};
+			}
+		};
+		for (int i = begin; i < end; ++i)
+		{
+			if (std::get<2>(population[i]) == birth)
+			{
+				if (repair_notes[i].known_total_runtime >= 0)
+				{
+					std::get<1>(population[i]) = solution_template.fitness_of_runtime(repair_notes[i].known_total_runtime);
+					repair_notes[i] = RepairNote{};
+					continue;
+				}
+				worker.batch_indices[worker.batch_evaluator.size()] = i;
+				worker.batch_evaluator.add(std::get<0>(population[i]));
+				if (worker.batch_evaluator.is_full())
+				{
+					flush_batch();
+				}
+			}
+		}
+		if (worker.batch_evaluator.size() > 0)
+		{
+			flush_batch();
+		}
+	};
+
+	// the pairs [begin, end) of the better half breed into the worse half, uses the `generation` of the loop below
+	// the children picked by the mutation mask are mutated here too, so the last repair of every child can be bounded
+	int generation{ 0 };
+	auto breed_pairs = [&](int begin, int end, int worker_id) {
+		GeneticWorker<Decoder>& worker = *workers[worker_id];
+		for (int pair = begin; pair < end; ++pair)
+		{
+			const int i = pair * 2;
+
+			// obtain their chromosomes
+			const BasicChromosome<Gene>* parents[2] = { &std::get<0>(population[i]), &std::get<0>(population[i + 1]) };
+
+			// crossover the chosen chromosomes obtaining the new pair
+			CounterRandom random_engine(seed, generation, i, RandomStream::Crossover);
+			auto offspring = Crossover::apply(*parents[0], *parents[1], random_engine);
+
+			// put the new pair into the second half of the population, with the generation number
+			BasicChromosome<Gene>* children[2] = { &offspring.first, &offspring.second };
+			for (int child = 0; child < 2; ++child)
+			{
+				const int index = population_size / 2 + i + child;
+				CounterRandom mutation_random_engine(seed, generation, index, RandomStream::Mutation);
+				BasicChromosome<Gene> finished = finish_child<Mutation>(*children[child], mutation_mask[index] != 0, mutation_random_engine, worker.decoder, settings, runtime_bound);
+				if (finished.empty())
+				{
+					++worker.aborted_repairs;
+					population[index] = { *parents[child], REJECTED_FITNESS, REJECTED_BIRTH };
+					continue;
+				}
+				population[index] = { std::move(finished), 0, generation + 1 };
+				repair_notes[index] = worker.decoder.memo.note;
+			}
+		}
+	};
+
+	// mutates the survivors [begin, end) picked by the mutation mask, the children are mutated as they are bred
+	auto mutate_specimens = [&](int begin, int end, int worker_id) {
+		GeneticWorker<Decoder>& worker = *workers[worker_id];
+		for (int i = begin; i < end; ++i)
+		{
+			auto& specimen = population[i];
+			if (mutation_mask[i])
+			{
+				CounterRandom random_engine(seed, generation, i, RandomStream::Mutation);
+				std::get<0>(specimen) = Mutation::apply(std::get<0>(specimen), random_engine, worker.decoder, settings);
+
+				if (std::get<2>(specimen) == generation)
+				{
+					// if we mutated the chromosome in the current generation,
+					// we need to recalculate the fitness as we calculate the fitness only once per new generation
+					int total_runtime = worker.decoder.memo.note.known_total_runtime;
+					if (total_runtime < 0)
+					{
+						worker.solution_template.fill_start_times(std::get<0>(specimen));
+						total_runtime = worker.solution_template.total_runtime();
+					}
+					std::get<1>(specimen) = solution_template.fitness_of_runtime(total_runtime);
+				}
+			}
+		}
+	};
+
+	// the pipelined mode sorts each block of parents and each block of children on its own, these are their bounds
+	std::vector<int> block_bounds;
+	for (int half_begin : { 0, population_size / 2 })
+	{
+		for (int begin = half_begin; begin < half_begin + population_size / 2; begin += 2 * pairs_grain)
+		{
+			block_bounds.push_back(begin);
+		}
+	}
+	block_bounds.push_back(population_size);
+	std::vector<char> is_block_stale(block_bounds.size() - 1);
+	Fitness published_fitness = std::numeric_limits<Fitness>::lowest();
+
+	for (; generation < settings.generations; ++generation)
+	{
+		if (!is_pipelined || generation == 0)
+		{
+			scheduler.parallel_for(population_size, specimens_grain, [&](int begin, int end, int worker_id) {
+				evaluate_newborn(begin, end, worker_id, generation);
+				});
+			// sort the population by fitness descending
+			if (is_pipelined)
+			{
+				// the pipelined mode merges stably sorted blocks, so it starts from a stable order too
+				std::stable_sort(population.begin(), population.end(), is_fitter);
+			}
+			else
+			{
+				std::sort(population.begin(), population.end(), is_fitter);
+			}
+		}
+
+		// the schedules evaluated since the last time go into the cache here, between the parallel loops
+		if (fitness_cache.is_enabled())
+		{
+			for (auto& worker : workers)
+			{
+				std::move(worker->pending_inserts.begin(), worker->pending_inserts.end(), std::back_inserter(pending_inserts));
+				worker->pending_inserts.clear();
+			}
+			insert_pending(fitness_cache, pending_inserts);
+		}
+
+		// the population is sorted at this point, the places of the rejected children are at its end
+		const int evaluated_count = static_cast<int>(std::partition_point(population.begin(), population.end(), is_evaluated) - population.begin());
+
+		// a fitter first specimen is a new best schedule
+		if (settings.improvement_listener != nullptr && std::get<1>(population[0]) > published_fitness)
+		{
+			published_fitness = std::get<1>(population[0]);
+			SolutionTemplate& listener_template = workers[0]->solution_template;
+			listener_template.fill_start_times(std::get<0>(population[0]));
+			publish_improvement(settings, std::get<0>(population[0]), listener_template.total_runtime());
+		}
+
+		if (!settings.is_quiet && generation % 50 == 0)
+		{
+			long long aborted_repairs{ 0 };
+			for (const auto& worker : workers)
+			{
+				aborted_repairs += worker->aborted_repairs;
+			}
+			const auto [cache_hits, cache_lookups] = count_cache();
+			// the quiet runs side by side in the portfolio or the batch don't touch the format of cout
+			std::cout << std::fixed << std::setprecision(2);
+			const auto [unique_schedules, mean_distance] = measure_diversity(solution_template, population, evaluated_count, settings.diversity_sample_size);
+			std::cout << "generation " << generation
+				<< "\tbest fitnesses: "
+				<< std::get<1>(population[0]) << ", "
+				<< std::get<1>(population[1]) << ", "
+				<< std::get<1>(population[2])
+				<< "\tworst fitnesses: "
+				<< std::get<1>(population[evaluated_count - 2]) << ", "
+				<< std::get<1>(population[evaluated_count - 1])
+				<< "\tunique: " << unique_schedules
+				<< "\tdistance: " << mean_distance
+				<< "\tduplicates replaced: " << duplicates_replaced
+				<< "\taborted repairs: " << aborted_repairs
+				<< "\tcache hits: " << cache_hits << "/" << cache_lookups << "\n";
+		}
+
+		if (generation == settings.generations - 1)
+		{
+			// on the last generation we don't need to breed, just stop
+			if (!settings.is_quiet)
+			{
+				std::cout << "Last generation reached.\n";
+			}
+			break;
+		}
+		if (deadline.is_over())
+		{
+			// the population is evaluated and sorted at this point, so the best specimen is valid
+			if (!settings.is_quiet)
+			{
+				std::cout << "Time limit reached at generation " << generation << ".\n";
+			}
+			break;
+		}
+
+		// a child running longer than the worst survivor would end up in the worse half, to be replaced by the next children,
+		// so its repair can stop as soon as it does; the population is still sorted here, before the migrants and the selection,
+		// and the survivors are all evaluated, there are never more rejected children than children
+		SolutionTemplate& bound_template = workers[0]->solution_template;
+		bound_template.fill_start_times(std::get<0>(population[population_size / 2 - 1]));
+		runtime_bound = bound_template.total_runtime();
+
+		if (settings.migration_link != nullptr && generation > 0 && generation % settings.migration_interval == 0)
+		{
+			// the best specimens go out, the immigrants take the places of the worst ones allowed to breed
+			SolutionTemplate& migration_template = workers[0]->solution_template;
+			std::vector<Chromosome> emigrants;
+			for (int i = 0; i < std::min(settings.migrants_count, population_size / 2); ++i)
+			{
+				emigrants.emplace_back(std::get<0>(population[i]).begin(), std::get<0>(population[i]).end());
+			}
+			migration_template.fill_start_times(std::get<0>(population[0]));
+			const auto immigrants = settings.migration_link->exchange(emigrants, migration_template.total_runtime());
+			for (int i = 0; i < std::min(static_cast<int>(immigrants.size()), population_size / 2); ++i)
+			{
+				// an island with the other decoder can send start times too late for our genes, those stay outside
+				const auto [earliest, latest] = std::minmax_element(immigrants[i].begin(), immigrants[i].end());
+				if (*earliest < 0 || *latest > std::numeric_limits<Gene>::max())
+				{
+					continue;
+				}
+				BasicChromosome<Gene> chromosome(immigrants[i].begin(), immigrants[i].end());
+				migration_template.fill_start_times(chromosome);
+				// so does a schedule which isn't one, whatever sent it: the population holds only feasible specimens
+				if (!migration_template.is_feasible())
+				{
+					continue;
+				}
+				const double fitness = solution_template.fitness_of_runtime(migration_template.total_runtime());
+				population[population_size / 2 - 1 - i] = { std::move(chromosome), fitness, generation };
+			}
+		}
+
+		Selection::before_breeding(population, evaluated_count);
+
+		// the decisions for all the specimens are made at once
+		CounterRandom mask_random_engine(seed, generation, 0, RandomStream::MutationMask);
+		fill_mask(mask_random_engine, mutation_mask, settings.mutation_probability);
+
+		if (is_pipelined)
+		{
+			// a block of pairs owns its parents in the first half and its children in the second half,
+			// so it goes through all the stages without waiting for the rest of the population
+			scheduler.parallel_for(population_size / 4, pairs_grain, [&](int begin, int end, int worker_id) {
+				breed_pairs(begin, end, worker_id);
+				mutate_specimens(begin * 2, end * 2, worker_id);
+				evaluate_newborn(population_size / 2 + begin * 2, population_size / 2 + end * 2, worker_id, generation + 1);
+				std::stable_sort(population.begin() + begin * 2, population.begin() + end * 2, is_fitter);
+				std::stable_sort(population.begin() + population_size / 2 + begin * 2, population.begin() + population_size / 2 + end * 2, is_fitter);
+				});
+		}
+		else
+		{
+			// for each pair of specimens in the first half of the population
+			scheduler.parallel_for(population_size / 4, pairs_grain, [&](int begin, int end, int worker_id) {
+				breed_pairs(begin, end, worker_id);
+				});
+
+			// mutate the survivors
+			scheduler.parallel_for(population_size / 2, specimens_grain, [&](int begin, int end, int worker_id) {
+				mutate_specimens(begin, end, worker_id);
+				});
+		}
+
+		if (settings.is_duplicate_elimination_enabled)
+		{
+			// the better specimens come first, so of all the clones we keep the best one and replace the rest
+			// replacements are newborn, the fitness pass of the next generation evaluates them
+			population_signatures.clear();
+			for (int i = 0; i < population_size; ++i)
+			{
+				auto& specimen = population[i];
+				if (std::get<2>(specimen) == REJECTED_BIRTH || population_signatures.insert(schedule_signature(std::get<0>(specimen))).second)
+				{
+					continue;
+				}
+
+				CounterRandom random_engine(seed, generation, i, RandomStream::Diversity);
+				// the heavy mutation can still hit a schedule we already have, give it a few more tries and give up
+				for (int attempt = 0; attempt < 3; ++attempt)
+				{
+					std::get<0>(specimen) = mutate_heavily(std::get<0>(specimen), random_engine, decoder, settings);
+					if (population_signatures.insert(schedule_signature(std::get<0>(specimen))).second)
+					{
+						break;
+					}
+				}
+				repair_notes[i] = decoder.memo.note;
+				std::get<2>(specimen) = generation + 1;
+				++duplicates_replaced;
+				if (is_pipelined)
+				{
+					is_block_stale[std::upper_bound(block_bounds.begin(), block_bounds.end(), i) - block_bounds.begin() - 1] = true;
+				}
+			}
+		}
+
+		if (is_pipelined)
+		{
+			// the blocks with replacements are evaluated and sorted again, all the children of the generation there, not only the replacements
+			scheduler.parallel_for(static_cast<int>(is_block_stale.size()), 1, [&](int begin, int end, int worker_id) {
+				for (int block = begin; block < end; ++block)
+				{
+					if (is_block_stale[block])
+					{
+						evaluate_newborn(block_bounds[block], block_bounds[block + 1], worker_id, generation + 1);
+						std::stable_sort(population.begin() + block_bounds[block], population.begin() + block_bounds[block + 1], is_fitter);
+						is_block_stale[block] = false;
+					}
+				}
+				});
+			merge_sorted_runs(scheduler, population, block_bounds, is_fitter);
+		}
+	}
+
+	solution_template.fill_start_times(std::get<0>(population[0]));
+	if (settings.is_quiet)
+	{
+		return population[0];
+	}
+	std::cout << "Best solution found:\n";
+	solution_template.print();
+	solution_template.visualize();
+	std::cout << "Fitness: " << std::get<1>(population[0]) << "\n";
+	std::cout << "Generation: " << std::get<2>(population[0]) << "\n";
+	std::cout << "Scheduler: " << scheduler.threads_count() << " threads, " << scheduler.loops_count() << " loops, "
+		<< scheduler.steals_count() << " steals, busy " << scheduler.busy_time() << " s, idle " << scheduler.idle_time() << " s\n";
+	if (fitness_cache.is_enabled())
+	{
+		const auto [cache_hits, cache_lookups] = count_cache();
+		std::cout << "Fitness cache: " << cache_hits << " hits of " << cache_lookups << " lookups\n";
+	}
+
+	return population[0];
+}
+
+/**
+* Population of the steady-state modes.
+*
+* The population is never sorted. Specimens stay in their slots and the ordered index of (total runtime, slot)
+* gives the worst (and the best) specimen at any time, so every replacement is O(log n).
+* Signatures of all the specimens are kept too, so a child which is a clone of a specimen we have can be rejected in O(1).
+*/
+template <typename Gene>
+class SteadyStatePopulation
+{
+private:
+	SolutionTemplate& solution_template;
+	BasicPopulation<Gene> specimens;
+	std::vector<int> total_runtimes;
+	std::set<std::pair<int /* total runtime */, int /* slot */>> ordered_index;
+	std::unordered_multiset<uint64_t> signatures;
+
+public:
+	long long replacements{ 0 };
+	long long duplicates_rejected{ 0 };
+	long long aborted_repairs{ 0 }; // children rejected by the bound before their repair was finished
+
+	SteadyStatePopulation(SolutionTemplate& solution_template, int size)
+		: solution_template(solution_template), specimens(size), total_runtimes(size)
+	{
+	}
+
+	int size() const
+	{
+		return specimens.size();
+	}
+
+	/* fills the slot of the initial population */
+	void set(int slot, BasicChromosome<Gene>&& chromosome, int total_runtime, uint64_t signature)
+	{
+		specimens[slot] = { std::move(chromosome), solution_template.fitness_of_runtime(total_runtime), 0 };
+		total_runtimes[slot] = total_runtime;
+		ordered_index.insert({ total_runtime, slot });
+		signatures.insert(signature);
+	}
+
+	/* puts the child in place of the worst specimen if it's better and (optionally) not a clone, returns whether it did */
+	bool try_replace_worst(BasicChromosome<Gene>&& child, int total_runtime, uint64_t signature, int birth, bool is_duplicate_rejected)
+	{
+		const auto [worst_runtime, worst_slot] = *ordered_index.rbegin();
+		if (total_runtime >= worst_runtime)
+		{
+			return false;
+		}
+		if (is_duplicate_rejected && signatures.count(signature) > 0)
+		{
+			++duplicates_rejected;
+			return false;
+		}
+
+		ordered_index.erase(std::prev(ordered_index.end()));
+		signatures.erase(signatures.find(schedule_signature(std::get<0>(specimens[worst_slot]))));
+
+		specimens[worst_slot] = { std::move(child), solution_template.fitness_of_runtime(total_runtime), birth };
+		total_runtimes[worst_slot] = total_runtime;
+		ordered_index.insert({ total_runtime, worst_slot });
+		signatures.insert(signature);
+		++replacements;
+		return true;
+	}
+
+	/* the best of `tournament_size` random slots */
+	int tournament(CounterRandom& random_engine, int tournament_size) const
+	{
+		int winner = random_below(random_engine, size());
+		for (int round = 1; round < tournament_size; ++round)
+		{
+			const int candidate = random_below(random_engine, size());
+			if (total_runtimes[candidate] < total_runtimes[winner])
+			{
+				winner = candidate;
+			}
+		}
+		return winner;
+	}
+
+	const BasicChromosome<Gene>& chromosome(int slot) const
+	{
+		return std::get<0>(specimens[slot]);
+	}
+
+	const BasicSpecimen<Gene>& best() const
+	{
+		return specimens[ordered_index.begin()->second];
+	}
+
+	const BasicSpecimen<Gene>& worst() const
+	{
+		return specimens[ordered_index.rbegin()->second];
+	}
+
+	int best_total_runtime() const
+	{
+		return ordered_index.begin()->first;
+	}
+
+	int worst_total_runtime() const
+	{
+		return ordered_index.rbegin()->first;
+	}
+};
+
+/* progress line of the steady-state modes */
+template <typename Gene>
+void report_steady_state(const SteadyStatePopulation<Gene>& population, long long evaluation, const GeneticSettings& settings,
+	long long cache_hits, long long cache_lookups)
+{
+	if (settings.is_quiet)
+	{
+		return;
+	}
+	std::cout << std::fixed << std::setprecision(2)
+		<< "evaluations " << evaluation
+		<< "\tbest fitness: " << std::get<1>(population.best())
+		<< "\tworst fitness: " << std::get<1>(population.worst())
+		<< "\tbest runtime: " << population.best_total_runtime()
+		<< "\treplacements: " << population.replacements
+		<< "\tduplicates rejected: " << population.duplicates_rejected
+		<< "\taborted repairs: " << population.aborted_repairs
+		<< "\tcache hits: " << cache_hits << "/" << cache_lookups << "\n";
+}
+
+/* final report of the steady-state modes, same as the one of the generational mode */
+template <typename Gene>
+void report_steady_state_result(SolutionTemplate& solution_template, const SteadyStatePopulation<Gene>& population, const GeneticSettings& settings)
+{
+	solution_template.fill_start_times(std::get<0>(population.best()));
+	if (settings.is_quiet)
+	{
+		return;
+	}
+	std::cout << "Best solution found:\n";
+	solution_template.print();
+	solution_template.visualize();
+	std::cout << "Fitness: " << std::get<1>(population.best()) << "\n";
+	std::cout << "Evaluation: " << std::get<2>(population.best()) << "\n";
+}
+
+/**
+* Breeds the pair of the steady-state modes: the crossover, then the mutation of the children picked by the mask,
+* all the numbers keyed by (seed, pair number).
+*
+* Children which turn out to run longer than `runtime_bound` come back empty, their last repair is given up halfway.
+* What the decoder knew of each child goes to `notes`.
+*/
+template <class Crossover, class Mutation, class Decoder, typename Gene>
+std::pair<BasicChromosome<Gene>, BasicChromosome<Gene>> breed_steady_state_pair(const BasicChromosome<Gene>& parent1, const BasicChromosome<Gene>& parent2,
+	uint64_t seed, uint32_t pair, Decoder& decoder, const GeneticSettings& settings, int runtime_bound, RepairNote* notes)
+{
+	CounterRandom mask_random_engine(seed, pair, 0, RandomStream::MutationMask);
+	bool is_mutated[2];
+	for (int child = 0; child < 2; ++child)
+	{
+		is_mutated[child] = static_cast<int>(random_below(mask_random_engine, 100)) < settings.mutation_probability;
+	}
+
+	CounterRandom crossover_random_engine(seed, pair, 0, RandomStream::Crossover);
+	auto offspring = Crossover::apply(parent1, parent2, crossover_random_engine);
+
+	BasicChromosome<Gene>* children[2] = { &offspring.first, &offspring.second };
+	for (int child = 0; child < 2; ++child)
+	{
+		CounterRandom random_engine(seed, pair, child, RandomStream::Mutation);
+		*children[child] = finish_child<Mutation>(*children[child], is_mutated[child], random_engine, decoder, settings, runtime_bound);
+		notes[child] = decoder.memo.note;
+	}
+
+	return offspring;
+}
+
+/*
+ * Signatures and total runtimes of the children, the rejected (empty) ones are skipped and get the longest runtime possible.
+ * The runtimes the fitness cache knew (see `notes`) are taken as they are.
+ */
+template <class Evaluator, typename Gene>
+void evaluate_children(Evaluator& evaluator, const BasicChromosome<Gene>* children, const RepairNote* notes, int count, uint64_t* signatures, int* total_runtimes)
+{
+	int finished_runtimes[BATCH_LANES];
+	int lanes[BATCH_LANES];
+	int finished_count{ 0 };
+	for (int child = 0; child < count; ++child)
+	{
+		total_runtimes[child] = std::numeric_limits<int>::max();
+		if (!children[child].empty())
+		{
+			signatures[child] = schedule_signature(children[child]);
+			if (notes[child].known_total_runtime >= 0)
+			{
+				total_runtimes[child] = notes[child].known_total_runtime;
+				continue;
+			}
+			evaluator.add(children[child]);
+			lanes[finished_count++] = child;
+		}
+	}
+	if (finished_count == 0)
+	{
+		return;
+	}
+	evaluator.evaluate(finished_runtimes);
+	for (int i = 0; i < finished_count; ++i)
+	{
+		total_runtimes[lanes[i]] = finished_runtimes[i];
+	}
+}
+
+/* evaluations budget of the steady-state modes */
+inline long long steady_state_evaluations(const GeneticSettings& settings)
+{
+	return settings.evaluations > 0 ? settings.evaluations : static_cast<long long>(settings.generations) * settings.population_size / 2;
+}
+
+/**
+* Steady-state GA: instead of replacing the half of the population every generation,
+* we breed one pair at a time and put each child in place of the worst specimen if the child is better.
+* Parents are picked by tournament: the best of `tournament_size` random specimens.
+*
+* The selection policy is not used here, the tournament is the selection.
+* Progress is reported in evaluations, one evaluation is one child.
+*/
+template <class Crossover, class Mutation, class Decoder, typename Gene>
+BasicSpecimen<Gene> solve_using_steady_state_genetic_algorithm(SolutionTemplate& solution_template, const GeneticSettings& settings, uint64_t seed)
+{
+	const int population_size = settings.population_size;
+	const long long evaluations = steady_state_evaluations(settings);
+	const long long report_interval = static_cast<long long>(population_size) * 25; // same as every 50 generations of the generational mode
+	const Deadline deadline(settings.time_limit);
+	Decoder decoder(solution_template);
+	FitnessCache fitness_cache(settings.fitness_cache_capacity, solution_template.get_graph().tasks_count());
+	if (fitness_cache.is_enabled())
+	{
+		decoder.memo.cache = &fitness_cache;
+	}
+
+	SteadyStatePopulation<Gene> population(solution_template, population_size);
+	typename Decoder::Evaluator evaluator(solution_template.get_graph());
+
+	// generate the initial population, evaluated in full batches
+	for (int begin = 0; begin < population_size; begin += BATCH_LANES)
+	{
+		const int count = std::min(BATCH_LANES, population_size - begin);
+		BasicChromosome<Gene> chromosomes[BATCH_LANES];
+		uint64_t signatures[BATCH_LANES];
+		int total_runtimes[BATCH_LANES];
+		RepairNote notes[BATCH_LANES];
+		for (int i = 0; i < count; ++i)
+		{
+			CounterRandom random_engine(seed, 0, begin + i, RandomStream::Initialisation);
+			chromosomes[i] = make_chromosome<Gene>(random_engine, decoder);
+			notes[i] = decoder.memo.note;
+			signatures[i] = schedule_signature(chromosomes[i]);
+			evaluator.add(chromosomes[i]);
+		}
+		evaluator.evaluate(total_runtimes);
+		for (int i = 0; i < count; ++i)
+		{
+			if (notes[i].cache_key != 0)
+			{
+				fitness_cache.insert(notes[i].cache_key, chromosomes[i], total_runtimes[i]);
+			}
+			population.set(begin + i, std::move(chromosomes[i]), total_runtimes[i], signatures[i]);
+		}
+	}
+
+	// every step is one "generation" of the counter-based generator, so the run depends only on the seed
+	long long evaluation{ 0 };
+	long long next_report{ 0 };
+	int published_total_runtime = std::numeric_limits<int>::max();
+	for (uint32_t step{ 0 }; evaluation < evaluations; ++step)
+	{
+		if (settings.improvement_listener != nullptr && population.best_total_runtime() < published_total_runtime)
+		{
+			published_total_runtime = population.best_total_runtime();
+			publish_improvement(settings, std::get<0>(population.best()), published_total_runtime);
+		}
+		if (evaluation >= next_report)
+		{
+			report_steady_state(population, evaluation, settings, decoder.memo.hits, decoder.memo.lookups);
+			next_report += report_interval;
+		}
+		if (step % 512 == 0 && deadline.is_over())
+		{
+			if (!settings.is_quiet)
+			{
+				std::cout << "Time limit reached at evaluation " << evaluation << ".\n";
+			}
+			break;
+		}
+
+		CounterRandom selection_random_engine(seed, step, 0, RandomStream::Tournament);
+		const int parent1 = population.tournament(selection_random_engine, settings.tournament_size);
+		const int parent2 = population.tournament(selection_random_engine, settings.tournament_size);
+
+		// a child which isn't better than the worst specimen is thrown away anyway, so its repair can stop as soon as it's not
+		BasicChromosome<Gene> children[2];
+		RepairNote notes[2];
+		std::tie(children[0], children[1]) = breed_steady_state_pair<Crossover, Mutation>(population.chromosome(parent1), population.chromosome(parent2),
+			seed, step, decoder, settings, population.worst_total_runtime() - 1, notes);
+
+		uint64_t signatures[2];
+		int results[2];
+		evaluate_children(evaluator, children, notes, 2, signatures, results);
+		evaluation += 2;
+
+		for (int child = 0; child < 2; ++child)
+		{
+			if (children[child].empty())
+			{
+				++population.aborted_repairs;
+				continue;
+			}
+			if (notes[child].cache_key != 0)
+			{
+				fitness_cache.insert(notes[child].cache_key, children[child], results[child]);
+			}
+			population.try_replace_worst(std::move(children[child]), results[child], signatures[child], static_cast<int>(evaluation), settings.is_duplicate_elimination_enabled);
+		}
+	}
+	report_steady_state(population, evaluation, settings, decoder.memo.hits, decoder.memo.lookups);
+	report_steady_state_result(solution_template, population, settings);
+
+	return population.best();
+}
+
+/* work item of the asynchronous mode: a slot of the initial population to make or a pair of parents to breed */
+template <typename Gene>
+struct BreedingTask
+{
+	uint32_t id; // slot of the initial population or the number of the pair
+	bool is_initialisation;
+	BasicChromosome<Gene> parent1{};
+	BasicChromosome<Gene> parent2{};
+};
+
+/* the children of the task, decoded and evaluated */
+template <typename Gene>
+struct BreedingResult
+{
+	uint32_t id;
+	bool is_initialisation;
+	int children_count;
+	BasicChromosome<Gene> children[2]{};
+	int total_runtimes[2]{};
+	uint64_t signatures[2]{};
+	RepairNote notes[2]{};
+	int cache_hits{ 0 }; // of the worker's fitness cache, for this task only
+	int cache_lookups{ 0 };
+};
+
+/**
+* Asynchronous master-worker GA: the steady-state GA without waiting for anything.
+*
+* The calling thread is the coordinator, it owns the population.
+* It picks the parents by tournament and puts the pairs into the task queue, keeping every worker supplied with work.
+* Workers take the pairs, breed, mutate, decode and evaluate the children on their own copy of the solution template,
+* and put them into the result queue. The coordinator takes the results in whatever order they come and does the replacement.
+* So a chromosome which takes 10 passes of `resolve_conflicts()` delays only itself, nobody waits at a barrier.
+*
+* The initial population is made by the workers the same way.
+*
+* Each pair is still bred with the numbers keyed by (seed, pair number), but which specimens are the parents
+* depends on the order the results arrive, so the runs are NOT repeatable with the same seed, unlike in the other modes.
+* For the same reason every worker has a fitness cache of its own, which it fills as it goes.
+*/
+template <class Crossover, class Mutation, class Decoder, typename Gene>
+BasicSpecimen<Gene> solve_using_asynchronous_genetic_algorithm(SolutionTemplate& solution_template, const GeneticSettings& settings, uint64_t seed)
+{
+	const int population_size = settings.population_size;
+	const long long evaluations = steady_state_evaluations(settings);
+	const long long report_interval = static_cast<long long>(population_size) * 25;
+	const int workers_count = settings.threads;
+	// enough tasks in flight to never leave a worker without work while the coordinator is busy with the results
+	const int max_in_flight = workers_count * 4;
+	const Deadline deadline(settings.time_limit);
+
+	SteadyStatePopulation<Gene> population(solution_template, population_size);
+	ConcurrentQueue<BreedingTask<Gene>> tasks(max_in_flight);
+	ConcurrentQueue<BreedingResult<Gene>> results(max_in_flight);
+	// the queues never block, these count what's in them, so an idle worker or coordinator sleeps instead of polling
+	std::counting_semaphore<> tasks_ready(0);
+	std::counting_semaphore<> results_ready(0);
+	std::atomic<bool> is_finished{ false };
+	// the incumbent: the longest total runtime a child may have to get into the population, read by all the workers
+	std::atomic<int> runtime_bound{ std::numeric_limits<int>::max() };
+
+	auto work = [&]() {
+		// the template is where the decoder does its work, so every worker needs its own
+		SolutionTemplate worker_template(solution_template);
+		Decoder decoder(worker_template);
+		typename Decoder::Evaluator evaluator(worker_template.get_graph());
+		FitnessCache fitness_cache(settings.fitness_cache_capacity, worker_template.get_graph().tasks_count());
+		if (fitness_cache.is_enabled())
+		{
+			decoder.memo.cache = &fitness_cache;
+		}
+		BreedingTask<Gene> task;
+		for (;;)
+		{
+			tasks_ready.acquire();
+			if (is_finished.load(std::memory_order_acquire))
+			{
+				return;
+			}
+			// never fails, the coordinator is the only producer and it releases the semaphore once the task is in
+			tasks.try_pop(task);
+
+			BreedingResult<Gene> result{ task.id, task.is_initialisation, 0 };
+			const long long hits_before = decoder.memo.hits;
+			const long long lookups_before = decoder.memo.lookups;
+			if (task.is_initialisation)
+			{
+				CounterRandom random_engine(seed, 0, task.id, RandomStream::Initialisation);
+				result.children[0] = make_chromosome<Gene>(random_engine, decoder);
+				result.children_count = 1;
+			}
+			else
+			{
+				// the bound may be a bit stale, but the worst specimen only gets better, so it's never too strict
+				std::tie(result.children[0], result.children[1]) = breed_steady_state_pair<Crossover, Mutation>(task.parent1, task.parent2,
+					seed, task.id, decoder, settings, runtime_bound.load(std::memory_order_relaxed), result.notes);
+				result.children_count = 2;
+			}
+			evaluate_children(evaluator, result.children, result.notes, result.children_count, result.signatures, result.total_runtimes);
+			for (int child = 0; child < result.children_count; ++child)
+			{
+				if (!result.children[child].empty() && result.notes[child].cache_key != 0)
+				{
+					fitness_cache.insert(result.notes[child].cache_key, result.children[child], result.total_runtimes[child]);
+				}
+			}
+			result.cache_hits = static_cast<int>(decoder.memo.hits - hits_before);
+			result.cache_lookups = static_cast<int>(decoder.memo.lookups - lookups_before);
+
+			// never fails, there are never more results than tasks in flight
+			results.try_push(std::move(result));
+			results_ready.release();
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (int i = 0; i < workers_count; ++i)
+	{
+		workers.emplace_back(work);
+	}
+
+	long long evaluation{ 0 };
+	long long next_report{ 0 };
+	uint32_t next_pair{ 0 };
+	uint32_t next_slot{ 0 };
+	int initialised{ 0 };
+	int in_flight{ 0 };
+	bool is_stopping{ false };
+	int published_total_runtime = std::numeric_limits<int>::max();
+	long long cache_hits{ 0 };
+	long long cache_lookups{ 0 };
+	BreedingResult<Gene> result;
+	while (initialised < population_size || (!is_stopping && evaluation < evaluations) || in_flight > 0)
+	{
+		// supply the workers: first the initial population, then the pairs, the parents are known only once it's complete
+		while (in_flight < max_in_flight && !is_stopping)
+		{
+			BreedingTask<Gene> task;
+			if (next_slot < static_cast<uint32_t>(population_size))
+			{
+				task = { next_slot++, true };
+			}
+			else if (initialised == population_size && evaluation + 2 * in_flight < evaluations)
+			{
+				CounterRandom selection_random_engine(seed, next_pair, 0, RandomStream::Tournament);
+				task = { next_pair++, false,
+					population.chromosome(population.tournament(selection_random_engine, settings.tournament_size)),
+					population.chromosome(population.tournament(selection_random_engine, settings.tournament_size)) };
+			}
+			else
+			{
+				break;
+			}
+			// never fails, there are never more tasks than tasks in flight
+			tasks.try_push(std::move(task));
+			tasks_ready.release();
+			++in_flight;
+		}
+
+		// there's always a task in flight here, so a result is coming
+		results_ready.acquire();
+		// the semaphore counts the finished pushes, but the one at the head may be a worker's which is still being written
+		while (!results.try_pop(result))
+		{
+			std::this_thread::yield();
+		}
+		--in_flight;
+		cache_hits += result.cache_hits;
+		cache_lookups += result.cache_lookups;
+
+		if (result.is_initialisation)
+		{
+			population.set(result.id, std::move(result.children[0]), result.total_runtimes[0], result.signatures[0]);
+			++initialised;
+			if (initialised == population_size)
+			{
+				runtime_bound.store(population.worst_total_runtime() - 1, std::memory_order_relaxed);
+			}
+			continue;
+		}
+
+		evaluation += result.children_count;
+		for (int child = 0; child < result.children_count; ++child)
+		{
+			if (result.children[child].empty())
+			{
+				++population.aborted_repairs;
+				continue;
+			}
+			if (population.try_replace_worst(std::move(result.children[child]), result.total_runtimes[child], result.signatures[child], static_cast<int>(evaluation), settings.is_duplicate_elimination_enabled))
+			{
+				runtime_bound.store(population.worst_total_runtime() - 1, std::memory_order_relaxed);
+			}
+		}
+		if (settings.improvement_listener != nullptr && population.best_total_runtime() < published_total_runtime)
+		{
+			published_total_runtime = population.best_total_runtime();
+			publish_improvement(settings, std::get<0>(population.best()), published_total_runtime);
+		}
+		if (evaluation >= next_report)
+		{
+			report_steady_state(population, evaluation, settings, cache_hits, cache_lookups);
+			next_report += report_interval;
+		}
+		if (!is_stopping && deadline.is_over())
+		{
+			// no new tasks, the ones in flight are still collected
+			if (!settings.is_quiet)
+			{
+				std::cout << "Time limit reached at evaluation " << evaluation << ".\n";
+			}
+			is_stopping = true;
+		}
+	}
+
+	is_finished.store(true, std::memory_order_release);
+	tasks_ready.release(workers_count);
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+
+	if (!settings.is_quiet)
+	{
+		std::cout << "Workers: " << workers_count << "\n";
+	}
+	report_steady_state(population, evaluation, settings, cache_hits, cache_lookups);
+	report_steady_state_result(solution_template, population, settings);
+
+	return population.best();
+}
+
+/*
+ * Runs the configuration in the mode from the settings, with the given width of the genes.
+ * The steady-state modes don't use the selection policy, so it's instantiated once for all of them.
+ */
+template <class Crossover, class Selection, class Mutation, class Decoder, typename Gene>
+Chromosome solve_genetic_mode(SolutionTemplate& solution_template, const GeneticSettings& settings, uint64_t seed)
+{
+	BasicSpecimen<Gene> best;
+	switch (settings.mode)
+	{
+	case GeneticMode::Generational:
+	case GeneticMode::Pipelined:
+		best = solve_using_genetic_algorithm<Crossover, Selection, Mutation, Decoder, Gene>(solution_template, settings, seed);
+		break;
+	case GeneticMode::SteadyState:
+		best = solve_using_steady_state_genetic_algorithm<Crossover, Mutation, Decoder, Gene>(solution_template, settings, seed);
+		break;
+	case GeneticMode::Asynchronous:
+		best = solve_using_asynchronous_genetic_algorithm<Crossover, Mutation, Decoder, Gene>(solution_template, settings, seed);
+		break;
+	}
+	return Chromosome(std::get<0>(best).begin(), std::get<0>(best).end());
+}
+
+/*
+ * Picks the width of the genes for the configuration and runs it.
+ *
+ * 16-bit genes halve the memory traffic over the population, but they are safe only if no start time ever gets past 32767.
+ * With the compaction every repaired start time is below the horizon, and mutations add at most the max mutation value
+ * (or the heavy mutation value for the duplicates) on top of that. A start time g which a negative mutation value takes below 0
+ * is reflected to g - value instead, so minus the min mutation value bounds the growth just the same.
+ * Without the compaction `resolve_conflicts()` can push tasks arbitrarily far, so we stay with 32 bits.
+ */
+template <class Crossover, class Selection, class Mutation, class Decoder>
+Chromosome solve_genetic_configuration(SolutionTemplate& solution_template, const GeneticSettings& settings, uint64_t seed)
+{
+	const bool are_16bit_genes_enough = Decoder::is_compacting
+		&& solution_template.horizon() + std::max({ settings.max_mutation_value, -settings.min_mutation_value, settings.heavy_mutation_value }) + 1
+			<= std::numeric_limits<int16_t>::max();
+	if (!settings.is_quiet)
+	{
+		std::cout << "Gene storage: " << (are_16bit_genes_enough ? 16 : 32) << " bits\n";
+	}
+	if (are_16bit_genes_enough)
+	{
+		return solve_genetic_mode<Crossover, Selection, Mutation, Decoder, int16_t>(solution_template, settings, seed);
+	}
+	return solve_genetic_mode<Crossover, Selection, Mutation, Decoder, int32_t>(solution_template, settings, seed);
+}
+
+/* -------- the registry -------- */
+
+struct GeneticSolver
+{
+	const char* crossover;
+	const char* selection;
+	const char* mutation;
+	const char* decoder;
+	Chromosome(*solve)(SolutionTemplate&, const GeneticSettings&, uint64_t);
+};
+
+template <class... Policies>
+struct PolicyList {};
+
+typedef PolicyList<OnePointCrossover, TwoPointCrossover, UniformCrossover> Crossovers;
+typedef PolicyList<PureSelection, TaintedSelection> Selections;
+typedef PolicyList<SingularMutation, XorMutation, AdditiveMutation> Mutations;
+#ifdef NEC_FIXED_INSTANCE
+// built with `make fixed`, the decoder specialised for the generated instance is one more choice
+#include "FixedInstance.generated.h"
+typedef PolicyList<CompactingDecoder, PushLaterDecoder, FixedInstanceDecoder> Decoders;
+#else
+typedef PolicyList<CompactingDecoder, PushLaterDecoder> Decoders;
+#endif
+
+/* the cartesian product of the lists, one level per policy kind */
+template <class Crossover, class Selection, class Mutation, class... DecoderTypes>
+void register_decoders(std::vector<GeneticSolver>& solvers, PolicyList<DecoderTypes...>)
+{
+	(solvers.push_back({ Crossover::name, Selection::name, Mutation::name, DecoderTypes::name,
+		&solve_genetic_configuration<Crossover, Selection, Mutation, DecoderTypes> }), ...);
+}
+
+template <class Crossover, class Selection, class... MutationTypes>
+void register_mutations(std::vector<GeneticSolver>& solvers, PolicyList<MutationTypes...>)
+{
+	(register_decoders<Crossover, Selection, MutationTypes>(solvers, Decoders{}), ...);
+}
+
+template <class Crossover, class... SelectionTypes>
+void register_selections(std::vector<GeneticSolver>& solvers, PolicyList<SelectionTypes...>)
+{
+	(register_mutations<Crossover, SelectionTypes>(solvers, Mutations{}), ...);
+}
+
+template <class... CrossoverTypes>
+void register_crossovers(std::vector<GeneticSolver>& solvers, PolicyList<CrossoverTypes...>)
+{
+	(register_selections<CrossoverTypes>(solvers, Selections{}), ...);
+}
+
+/* throws if `decoder` can't repair the problem of the template, so a run can be refused before any of its work starts */
+inline void check_genetic_decoder(const std::string& decoder, const SolutionTemplate& solution_template)
+{
+#ifdef NEC_FIXED_INSTANCE
+	if (decoder == FixedInstanceDecoder::name)
+	{
+		FixedInstanceDecoder::check_instance(solution_template);
+	}
+#else
+	(void)decoder;
+	(void)solution_template;
+#endif
+}
+
+/* all the pre-instantiated configurations */
+inline const std::vector<GeneticSolver>& genetic_solvers()
+{
+	static const std::vector<GeneticSolver> solvers = []() {
+		std::vector<GeneticSolver> result;
+		register_crossovers(result, Crossovers{});
+		return result;
+		}();
+	return solvers;
+}
+
+/* throws if there's no such combination, the message lists the known names */
+inline const GeneticSolver& find_genetic_solver(const std::string& crossover, const std::string& selection, const std::string& mutation, const std::string& decoder)
+{
+	for (const auto& solver : genetic_solvers())
+	{
+		if (crossover == solver.crossover && selection == solver.selection && mutation == solver.mutation && decoder == solver.decoder)
+		{
+			return solver;
+		}
+	}
+	throw std::runtime_error("Unknown GA configuration: " + crossover + " / " + selection + " / " + mutation + " / " + decoder
+		+ ". Crossovers: 1-point, 2-point, uniform. Selections: pure, tainted. Mutations: singular, uniform XOR, uniform additive. Decoders: compacting, push-later, fixed (only in `main_fixed`, see `make fixed`).");
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+#include <csignal>
+#endif
+
+#include "common.h"
+
+/**
+* Streams every new best schedule of the run as soon as the solver finds it, so whoever waits for the schedule
+* can start with the first usable one within a second and take the better ones as they come, instead of waiting for the end of the run.
+*
+* Every improvement is one JSON line:
+*     {"total_runtime": 1252, "seconds": 0.84, "start_times": [0, 190, 234, ...]}
+* with the seconds since the start of the run and the start times in the order of the tasks in the problem file.
+* The last line is the best schedule of the run.
+*
+* The solver must never wait for the consumer, so `improved()` only leaves the schedule in a slot and returns,
+* and the writing is done by a thread of its own. If the consumer is slower than the improvements,
+* the schedules nobody had time to read are replaced by the better ones, only the newest best is ever worth reading.
+* The file is opened by that thread too, so a named pipe nobody reads yet doesn't hold up the run either,
+* only its end waits for a reader to take the last (best) schedule. A reader which goes away just stops the publishing.
+*/
+class ImprovementPublisher : public ImprovementListener
+{
+private:
+	const std::string filename;
+	const std::chrono::steady_clock::time_point start;
+
+	// the best total runtime offered so far, most of the calls are not better and don't need the lock
+	std::atomic<int> best_total_runtime{ std::numeric_limits<int>::max() };
+
+	std::mutex mutex;
+	std::condition_variable has_news;
+	Chromosome pending;
+	int pending_total_runtime{ std::numeric_limits<int>::max() }; // stays after the writer takes the schedule
+	double pending_seconds{ 0.0 };
+	bool is_pending{ false };
+	bool is_stopping{ false };
+
+	long long published{ 0 };
+	long long superseded{ 0 }; // replaced by a better one before they were written
+
+	std::thread writer;
+
+	void write_all()
+	{
+		std::ofstream file(filename);
+		if (!file.is_open())
+		{
+			std::cerr << "Failed to open the improvements file " << filename << ", the improvements are not published.\n";
+		}
+		Chromosome best;
+		for (;;)
+		{
+			int total_runtime;
+			double seconds;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				has_news.wait(lock, [&]() { return is_pending || is_stopping; });
+				if (!is_pending)
+				{
+					return;
+				}
+				best.swap(pending);
+				total_runtime = pending_total_runtime;
+				seconds = pending_seconds;
+				is_pending = false;
+				++published;
+			}
+			if (!file.is_open())
+			{
+				continue;
+			}
+			std::ostringstream line;
+			line << "{\"total_runtime\": " << total_runtime << ", \"seconds\": " << seconds << ", \"start_times\": [";
+			for (size_t task = 0; task < best.size(); ++task)
+			{
+				line << (task == 0 ? "" : ", ") << best[task];
+			}
+			line << "]}\n";
+			// flushed every time, the consumer reads the lines as they come
+			if (!(file << line.str() << std::flush))
+			{
+				std::cerr << "Failed to write to the improvements file " << filename << ", the improvements are not published anymore.\n";
+				file.close();
+			}
+		}
+	}
+
+public:
+	explicit ImprovementPublisher(const std::string& filename)
+		: filename(filename), start(std::chrono::steady_clock::now()), writer(&ImprovementPublisher::write_all, this)
+	{
+#ifndef _WIN32
+		// a pipe whose reader is gone is a failed write, not a SIGPIPE killing the run
+		std::signal(SIGPIPE, SIG_IGN);
+#endif
+	}
+
+	ImprovementPublisher(const ImprovementPublisher&) = delete;
+	ImprovementPublisher& operator=(const ImprovementPublisher&) = delete;
+
+	~ImprovementPublisher()
+	{
+		finish();
+	}
+
+	/* writes what's left in the slot and stops the writer, the improvements after that are dropped */
+	void finish()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			is_stopping = true;
+		}
+		has_news.notify_one();
+		if (writer.joinable())
+		{
+			writer.join();
+		}
+	}
+
+	void improved(const Chromosome& best, int total_runtime) override
+	{
+		int current = best_total_runtime.load(std::memory_order_relaxed);
+		do
+		{
+			if (total_runtime >= current)
+			{
+				return;
+			}
+		} while (!best_total_runtime.compare_exchange_weak(current, total_runtime, std::memory_order_relaxed));
+
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			// another thread with an even better one could have come through the lock first, maybe it's even written already
+			if (pending_total_runtime <= total_runtime)
+			{
+				return;
+			}
+			superseded += is_pending;
+			pending = best;
+			pending_total_runtime = total_runtime;
+			pending_seconds = seconds;
+			is_pending = true;
+		}
+		has_news.notify_one();
+	}
+
+	/* final after `finish()` */
+	long long published_count()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return published;
+	}
+
+	long long superseded_count()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return superseded;
+	}
+};
@@ -0,0 +1,441 @@
+#pragma once
+
+#include "common.h"
+#include "SolutionTemplate.h"
+
+/*
+ * How to answer "what would the makespan be after this move":
+ * - Exact applies the move, reads the makespan and undoes it, touching only the affected cone of tasks.
+ * - Estimate does not touch the schedule at all, it's the O(1) formula over heads and tails (Taillard),
+ *   exact when the longest path after the move goes through one of the swapped tasks, a lower bound otherwise.
+ */
+enum class MoveEvaluation
+{
+	Exact,
+	Estimate,
+};
+
+/**
+* Schedule represented by the ORDER of the tasks on every machine instead of by the start times.
+*
+* This is the representation the local search solvers work with.
+* Start times (heads) are derived from the order: every task starts as soon as both
+* its predecessor in the job and its predecessor on the machine are finished (semi-active schedule).
+*
+* The point of this class is that a move (swap of two adjacent tasks on a machine)
+* does not require to recalculate the whole schedule like `resolve_conflicts()` does.
+* Only the tasks which are reachable from the swapped pair can change their start times,
+* so we propagate the changes forward from the swapped pair and stop as soon as the start times stop changing.
+*
+* Next to the heads we keep the tails: the length of the longest path from the end of the task to the end of the schedule.
+* head + length + tail of a task is the length of the longest path through it, so with both of them
+* the effect of a move can be estimated without applying it (see `MoveEvaluation`).
+*
+* Moves are applied with `apply_swap()` and can be rolled back with `undo()` in the reverse order,
+* until `commit()` forgets them.
+*
+* Memory used is a handful of arrays of the size of number of tasks, independent of anything else.
+*/
+class IncrementalSchedule
+{
+private:
+	/* static structure of the problem, copied from the graph of the solution template */
+	std::vector<int> lengths;
+	std::vector<int> job_predecessor; // -1 if the task is the first in its job
+	std::vector<int> job_successor; // -1 if the task is the last in its job
+	std::vector<int> machine_of_task;
+	std::vector<int> last_task_of_job;
+
+	/*
+	 * The order of the tasks on the machines, this is what the moves change.
+	 * Same CSR layout as `PrecedenceGraph::machine_tasks`: the machine `m` is `machine_order[machine_offsets[m]]` .. `machine_order[machine_offsets[m + 1] - 1]`.
+	 */
+	std::vector<int> machine_offsets;
+	std::vector<int /* index in tasks */> machine_order;
+	std::vector<int /* index in `machine_order` */> position_on_machine;
+
+	/* the earliest start times derived from the order, and the longest paths from the end of the tasks to the end of the schedule */
+	std::vector<int> heads;
+	std::vector<int> tails;
+	int current_makespan{ 0 };
+
+	/* moves applied since the last `commit()`, (machine ID, position) */
+	std::vector<std::pair<int, int>> undo_stack;
+
+	/*
+	 * Scratch space for the propagation, kept to not allocate on every move.
+	 * A task is never in the queue twice, so a ring of the size of number of tasks never overflows.
+	 */
+	std::vector<int> propagation_queue;
+	int queue_front{ 0 };
+	int queue_size{ 0 };
+	std::vector<char> is_queued;
+
+	int machine_predecessor(int task_index) const
+	{
+		const int position = position_on_machine[task_index];
+		return position == machine_offsets[machine_of_task[task_index]] ? -1 : machine_order[position - 1];
+	}
+
+	int machine_successor(int task_index) const
+	{
+		const int position = position_on_machine[task_index];
+		return position + 1 == machine_offsets[machine_of_task[task_index] + 1] ? -1 : machine_order[position + 1];
+	}
+
+	int end_of(int task_index) const
+	{
+		return task_index == -1 ? 0 : heads[task_index] + lengths[task_index];
+	}
+
+	int calculate_head(int task_index) const
+	{
+		return std::max(end_of(job_predecessor[task_index]), end_of(machine_predecessor(task_index)));
+	}
+
+	/* longest path from the start of the task to the end of the schedule */
+	int path_from(int task_index) const
+	{
+		return task_index == -1 ? 0 : lengths[task_index] + tails[task_index];
+	}
+
+	int calculate_tail(int task_index) const
+	{
+		return std::max(path_from(job_successor[task_index]), path_from(machine_successor(task_index)));
+	}
+
+	void enqueue(int task_index)
+	{
+		if (task_index != -1 && !is_queued[task_index])
+		{
+			is_queued[task_index] = 1;
+			int back = queue_front + queue_size++;
+			if (back >= static_cast<int>(propagation_queue.size()))
+			{
+				back -= propagation_queue.size();
+			}
+			propagation_queue[back] = task_index;
+		}
+	}
+
+	int dequeue()
+	{
+		const int task_index = propagation_queue[queue_front];
+		if (++queue_front == static_cast<int>(propagation_queue.size()))
+		{
+			queue_front = 0;
+		}
+		--queue_size;
+		is_queued[task_index] = 0;
+		return task_index;
+	}
+
+	/*
+	 * Label-correcting propagation of the heads.
+	 * The graph of the schedule is acyclic, so it always converges to the exact earliest start times,
+	 * and every task is touched only if some of its predecessors actually changed.
+	 */
+	void propagate()
+	{
+		while (queue_size > 0)
+		{
+			int task_index = dequeue();
+
+			int new_head = calculate_head(task_index);
+			if (new_head != heads[task_index])
+			{
+				heads[task_index] = new_head;
+				enqueue(job_successor[task_index]);
+				enqueue(machine_successor(task_index));
+			}
+		}
+	}
+
+	/* mirror image of `propagate()`, going from the end of the schedule backwards */
+	void propagate_backward()
+	{
+		while (queue_size > 0)
+		{
+			int task_index = dequeue();
+
+			int new_tail = calculate_tail(task_index);
+			if (new_tail != tails[task_index])
+			{
+				tails[task_index] = new_tail;
+				enqueue(job_predecessor[task_index]);
+				enqueue(machine_predecessor(task_index));
+			}
+		}
+	}
+
+	void swap_in_place(int machine_id, int position)
+	{
+		const int first = machine_offsets[machine_id] + position;
+		int u = machine_order[first];
+		int v = machine_order[first + 1];
+		std::swap(machine_order[first], machine_order[first + 1]);
+		position_on_machine[u] = first + 1;
+		position_on_machine[v] = first;
+
+		// these three changed their machine predecessors, everything else affected is reachable from them
+		enqueue(v);
+		enqueue(u);
+		enqueue(machine_successor(u));
+		propagate();
+
+		// and these three changed their machine successors
+		enqueue(u);
+		enqueue(v);
+		enqueue(machine_predecessor(v));
+		propagate_backward();
+
+		update_makespan();
+	}
+
+	void update_makespan()
+	{
+		// the last task of every job finishes the job, so only these can define the makespan
+		current_makespan = 0;
+		for (const auto task_index : last_task_of_job)
+		{
+			current_makespan = std::max(current_makespan, end_of(task_index));
+		}
+	}
+
+public:
+	/**
+	* Takes the order of the tasks on the machines from the start times in the chromosome.
+	* The chromosome does not need to be free of conflicts, only the relative order of start times on every machine matters.
+	*/
+	IncrementalSchedule(const SolutionTemplate& solution_template, const Chromosome& start_times)
+	{
+		const auto& graph = solution_template.get_graph();
+		const auto tasks_count = graph.tasks_count();
+
+		lengths = graph.lengths;
+		machine_of_task = graph.machine_of_task;
+		job_predecessor = graph.job_predecessor;
+		job_successor = graph.job_successor;
+		position_on_machine.resize(tasks_count);
+		heads.assign(tasks_count, 0);
+		tails.assign(tasks_count, 0);
+		propagation_queue.resize(tasks_count);
+		is_queued.assign(tasks_count, 0);
+
+		for (int job_id = 0; job_id < graph.jobs_count(); ++job_id)
+		{
+			last_task_of_job.push_back(graph.job_tasks[graph.job_offsets[job_id + 1] - 1]);
+		}
+
+		machine_offsets = graph.machine_offsets;
+		machine_order = graph.machine_tasks;
+		for (int machine_id = 0; machine_id < graph.machines_count(); ++machine_id)
+		{
+			// stable sort so equal start times keep the order from the template, same as everywhere else
+			std::stable_sort(machine_order.begin() + machine_offsets[machine_id], machine_order.begin() + machine_offsets[machine_id + 1], [&start_times](int a, int b) {
+				return start_times[a] < start_times[b];
+				});
+		}
+
+		recalculate();
+	}
+
+	/*
+	 * Full recalculation of the heads and the tails, used only once at the start.
+	 * Any unresolved job-level conflict in the initial order is fine, the order on machines defines the schedule.
+	 * But the order taken from start times of a chromosome with conflicts CAN contain a cycle
+	 * (task waits for a task on another machine which waits for it), in which case we throw.
+	 */
+	void recalculate()
+	{
+		for (int i = 0; i < static_cast<int>(machine_order.size()); ++i)
+		{
+			position_on_machine[machine_order[i]] = i;
+		}
+
+		// Kahn's topological order over job and machine arcs
+		const int tasks_count = static_cast<int>(lengths.size());
+		std::vector<int> incoming(tasks_count, 0);
+		for (auto i = 0; i < tasks_count; ++i)
+		{
+			incoming[i] = (job_predecessor[i] != -1) + (machine_predecessor(i) != -1);
+		}
+		std::vector<int> ready;
+		for (auto i = 0; i < tasks_count; ++i)
+		{
+			if (incoming[i] == 0)
+			{
+				ready.push_back(i);
+			}
+		}
+
+		std::vector<int> topological_order;
+		topological_order.reserve(tasks_count);
+		while (!ready.empty())
+		{
+			int task_index = ready.back();
+			ready.pop_back();
+			topological_order.push_back(task_index);
+
+			heads[task_index] = calculate_head(task_index);
+			for (const int next : { job_successor[task_index], machine_successor(task_index) })
+			{
+				if (next != -1 && --incoming[next] == 0)
+				{
+					ready.push_back(next);
+				}
+			}
+		}
+
+		if (static_cast<int>(topological_order.size()) != tasks_count)
+		{
+			throw std::runtime_error("Order of the tasks on the machines contains a cycle.");
+		}
+
+		for (auto it = topological_order.rbegin(); it != topological_order.rend(); ++it)
+		{
+			tails[*it] = calculate_tail(*it);
+		}
+
+		update_makespan();
+	}
+
+	int makespan() const
+	{
+		return current_makespan;
+	}
+
+	int machines_count() const
+	{
+		return machine_offsets.size() - 1;
+	}
+
+	int machine_length(int machine_id) const
+	{
+		return machine_offsets[machine_id + 1] - machine_offsets[machine_id];
+	}
+
+	/*
+	 * Swapping two adjacent tasks u, v on the machine is unsafe if there's another path from u to v in the graph:
+	 * the swap would create a cycle.
+	 * Such path must go through the job successor of u, and then v cannot start before that successor ends.
+	 * So if v starts earlier than that, there's no such path. Swaps of critical pairs always pass this check.
+	 */
+	bool is_swap_safe(int machine_id, int position) const
+	{
+		const int first = machine_offsets[machine_id] + position;
+		int u = machine_order[first];
+		int v = machine_order[first + 1];
+		int next_in_job = job_successor[u];
+		return next_in_job == -1 || heads[v] < end_of(next_in_job);
+	}
+
+	/**
+	* Swaps the tasks at `position` and `position + 1` on the machine and updates the heads and tails of the affected tasks only.
+	* The move is remembered, so it can be rolled back with `undo()`.
+	*/
+	void apply_swap(int machine_id, int position)
+	{
+		swap_in_place(machine_id, position);
+		undo_stack.emplace_back(machine_id, position);
+	}
+
+	/* rolls back the last applied move which wasn't committed */
+	void undo()
+	{
+		if (undo_stack.empty())
+		{
+			throw std::runtime_error("Nothing to undo.");
+		}
+		// swapping the same pair again puts everything back
+		const auto [machine_id, position] = undo_stack.back();
+		undo_stack.pop_back();
+		swap_in_place(machine_id, position);
+	}
+
+	/* forgets the applied moves, they can't be rolled back after this */
+	void commit()
+	{
+		undo_stack.clear();
+	}
+
+	/**
+	* What the makespan would be after swapping the tasks at `position` and `position + 1` on the machine.
+	* The schedule is left as it was in both modes.
+	*/
+	int evaluate_swap(int machine_id, int position, MoveEvaluation mode)
+	{
+		if (mode == MoveEvaluation::Exact)
+		{
+			apply_swap(machine_id, position);
+			const int result = current_makespan;
+			undo();
+			return result;
+		}
+
+		// the order is a, u, v, b and becomes a, v, u, b
+		const int first = machine_offsets[machine_id] + position;
+		const int u = machine_order[first];
+		const int v = machine_order[first + 1];
+		const int a = machine_predecessor(u);
+		const int b = machine_successor(v);
+
+		const int new_head_v = std::max(end_of(job_predecessor[v]), end_of(a));
+		const int new_head_u = std::max(end_of(job_predecessor[u]), new_head_v + lengths[v]);
+		const int new_tail_u = std::max(path_from(job_successor[u]), path_from(b));
+		const int new_tail_v = std::max(path_from(job_successor[v]), lengths[u] + new_tail_u);
+
+		return std::max(new_head_v + lengths[v] + new_tail_v, new_head_u + lengths[u] + new_tail_u);
+	}
+
+	int head(int task_index) const
+	{
+		return heads[task_index];
+	}
+
+	int tail(int task_index) const
+	{
+		return tails[task_index];
+	}
+
+	/*
+	 * Collects the pairs of adjacent tasks on the same machine which lie on one critical path.
+	 * Each pair is (machine ID, position of the first task of the pair).
+	 * Moves outside of the critical path cannot shorten the makespan, so these are the interesting ones.
+	 */
+	void critical_moves(std::vector<std::pair<int, int>>& moves) const
+	{
+		moves.clear();
+
+		int task_index = -1;
+		for (const auto last_task : last_task_of_job)
+		{
+			if (end_of(last_task) == current_makespan)
+			{
+				task_index = last_task;
+				break;
+			}
+		}
+
+		// walk the critical path backwards: there's always a predecessor ending exactly when the task starts
+		while (task_index != -1 && heads[task_index] > 0)
+		{
+			int previous_on_machine = machine_predecessor(task_index);
+			if (previous_on_machine != -1 && end_of(previous_on_machine) == heads[task_index])
+			{
+				const int machine_id = machine_of_task[task_index];
+				moves.emplace_back(machine_id, position_on_machine[previous_on_machine] - machine_offsets[machine_id]);
+				task_index = previous_on_machine;
+			}
+			else
+			{
+				task_index = job_predecessor[task_index];
+			}
+		}
+	}
+
+	Chromosome get_chromosome() const
+	{
+		return heads;
+	}
+};
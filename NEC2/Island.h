@@ -0,0 +1,798 @@
+#pragma once
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "common.h"
+#include "SolutionTemplate.h"
+#include "GeneticAlgorithm.h"
+
+/**
+* Island model over processes: one solve spread over several processes, on one host or on many.
+*
+* Every worker process is an ordinary GA run (`--island_address` set) on its own population, the island.
+* Every `migration_interval` generations it sends its best `migrants` chromosomes and its best total runtime
+* to the coordinator (`--solver_type "island coordinator"`) and gets back the latest migrants of the next island in the ring.
+* The coordinator keeps the best schedule it has seen, so when a worker dies mid-run, only its future work is lost:
+* the coordinator drops the connection and goes on with the others, and a worker which loses the coordinator goes on alone.
+* The run is over when `islands` workers have joined and all of them have finished or died.
+*
+* Addresses are `unix:/path/to/socket` or `tcp:host:port` (the coordinator listens on all the interfaces for TCP).
+*
+* The wire format is little-endian binary, every message is a frame:
+*   u32 magic "NEC2", u8 type, u32 payload length, payload
+* Payloads:
+*   Hello      (worker -> coordinator): u32 tasks count, u64 fingerprint of the problem
+*   Welcome    (coordinator -> worker): u32 island number, u64 seed of the island
+*   Migrants   (worker -> coordinator): i32 best total runtime, chromosomes
+*   Immigrants (coordinator -> worker): i32 best total runtime of all the islands, chromosomes
+*   Result     (worker -> coordinator): i32 total runtime, chromosomes (just the best one)
+* where chromosomes are u32 count, u32 length, then count * length i32 start times.
+*/
+
+enum class MessageType : uint8_t
+{
+	Hello = 1,
+	Welcome = 2,
+	Migrants = 3,
+	Immigrants = 4,
+	Result = 5,
+};
+
+/* builds a payload, byte by byte in little-endian, whatever the host is */
+class WireWriter
+{
+private:
+	std::vector<uint8_t> bytes;
+
+public:
+	void put_u8(uint8_t value)
+	{
+		bytes.push_back(value);
+	}
+
+	void put_bytes(const std::vector<uint8_t>& values)
+	{
+		bytes.insert(bytes.end(), values.begin(), values.end());
+	}
+
+	void put_u32(uint32_t value)
+	{
+		for (int shift = 0; shift < 32; shift += 8)
+		{
+			bytes.push_back(static_cast<uint8_t>(value >> shift));
+		}
+	}
+
+	void put_u64(uint64_t value)
+	{
+		put_u32(static_cast<uint32_t>(value));
+		put_u32(static_cast<uint32_t>(value >> 32));
+	}
+
+	void put_i32(int32_t value)
+	{
+		put_u32(static_cast<uint32_t>(value));
+	}
+
+	void put_chromosomes(const std::vector<Chromosome>& chromosomes)
+	{
+		put_u32(static_cast<uint32_t>(chromosomes.size()));
+		put_u32(chromosomes.empty() ? 0 : static_cast<uint32_t>(chromosomes[0].size()));
+		for (const auto& chromosome : chromosomes)
+		{
+			for (const auto gene : chromosome)
+			{
+				put_i32(gene);
+			}
+		}
+	}
+
+	const std::vector<uint8_t>& get_bytes() const
+	{
+		return bytes;
+	}
+};
+
+/* reads a payload back, throws if the payload is shorter than what's read from it */
+class WireReader
+{
+private:
+	const std::vector<uint8_t>& bytes;
+	size_t position{ 0 };
+
+	void require(size_t count) const
+	{
+		if (bytes.size() - position < count)
+		{
+			throw std::runtime_error("The message is shorter than its content.");
+		}
+	}
+
+public:
+	explicit WireReader(const std::vector<uint8_t>& bytes) : bytes(bytes) {}
+
+	uint8_t get_u8()
+	{
+		require(1);
+		return bytes[position++];
+	}
+
+	uint32_t get_u32()
+	{
+		require(4);
+		uint32_t value{ 0 };
+		for (int shift = 0; shift < 32; shift += 8)
+		{
+			value |= static_cast<uint32_t>(bytes[position++]) << shift;
+		}
+		return value;
+	}
+
+	uint64_t get_u64()
+	{
+		const uint64_t low = get_u32();
+		return low | (static_cast<uint64_t>(get_u32()) << 32);
+	}
+
+	int32_t get_i32()
+	{
+		return static_cast<int32_t>(get_u32());
+	}
+
+	std::vector<Chromosome> get_chromosomes()
+	{
+		const uint32_t count = get_u32();
+		const uint32_t length = get_u32();
+		require(static_cast<size_t>(count) * length * 4);
+		std::vector<Chromosome> chromosomes(count, Chromosome(length));
+		for (auto& chromosome : chromosomes)
+		{
+			for (auto& gene : chromosome)
+			{
+				gene = get_i32();
+			}
+		}
+		return chromosomes;
+	}
+};
+
+/* FNV-1a over the structure of the problem, so the coordinator can tell a worker which loaded a different file */
+inline uint64_t problem_fingerprint(const PrecedenceGraph& graph)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	auto add = [&hash](const std::vector<int>& values) {
+		for (const auto value : values)
+		{
+			hash = (hash ^ static_cast<uint32_t>(value)) * 0x100000001b3ull;
+		}
+	};
+	add(graph.lengths);
+	add(graph.job_of_task);
+	add(graph.machine_of_task);
+	return hash;
+}
+
+#ifndef _WIN32
+
+/* file descriptor of a connected or a listening socket, closed with the object */
+class Socket
+{
+private:
+	int descriptor{ -1 };
+
+	static constexpr uint32_t MAGIC = 0x3243454E; // "NEC2"
+	static constexpr uint32_t MAX_PAYLOAD = 64u << 20;
+
+	bool send_all(const uint8_t* data, size_t size)
+	{
+		while (size > 0)
+		{
+			// MSG_NOSIGNAL: a dead peer is an error to handle, not a SIGPIPE killing the process
+			const ssize_t sent = ::send(descriptor, data, size, MSG_NOSIGNAL);
+			if (sent <= 0)
+			{
+				return false;
+			}
+			data += sent;
+			size -= sent;
+		}
+		return true;
+	}
+
+	bool receive_all(uint8_t* data, size_t size)
+	{
+		while (size > 0)
+		{
+			const ssize_t received = ::recv(descriptor, data, size, 0);
+			if (received <= 0)
+			{
+				return false;
+			}
+			data += received;
+			size -= received;
+		}
+		return true;
+	}
+
+public:
+	static constexpr size_t HEADER_SIZE = 9; // magic, type, payload length
+
+	Socket() = default;
+	explicit Socket(int descriptor) : descriptor(descriptor) {}
+	Socket(Socket&& other) noexcept : descriptor(std::exchange(other.descriptor, -1)) {}
+	Socket& operator=(Socket&& other) noexcept
+	{
+		std::swap(descriptor, other.descriptor);
+		return *this;
+	}
+	Socket(const Socket&) = delete;
+	Socket& operator=(const Socket&) = delete;
+
+	~Socket()
+	{
+		close();
+	}
+
+	void close()
+	{
+		if (descriptor >= 0)
+		{
+			::close(descriptor);
+			descriptor = -1;
+		}
+	}
+
+	bool is_open() const
+	{
+		return descriptor >= 0;
+	}
+
+	int get() const
+	{
+		return descriptor;
+	}
+
+	/* a peer which stops halfway through a message is as good as dead, we don't wait for it forever */
+	void set_receive_timeout(int seconds)
+	{
+		timeval timeout{ seconds, 0 };
+		setsockopt(descriptor, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	}
+
+	/* false if the peer is gone */
+	bool send_message(MessageType type, const WireWriter& payload)
+	{
+		WireWriter frame;
+		frame.put_u32(MAGIC);
+		frame.put_u8(static_cast<uint8_t>(type));
+		frame.put_u32(static_cast<uint32_t>(payload.get_bytes().size()));
+		frame.put_bytes(payload.get_bytes());
+		return send_all(frame.get_bytes().data(), frame.get_bytes().size());
+	}
+
+	/* false if the peer is gone, or sent something which is not our frame */
+	bool receive_message(MessageType& type, std::vector<uint8_t>& payload)
+	{
+		std::vector<uint8_t> header(HEADER_SIZE);
+		uint32_t length;
+		if (!receive_all(header.data(), header.size()) || !read_header(header, type, length))
+		{
+			return false;
+		}
+		payload.resize(length);
+		return receive_all(payload.data(), length);
+	}
+
+	/*
+	 * Appends what has already arrived, without waiting for more, until `buffer` has `size` bytes.
+	 * false if the peer is gone.
+	 */
+	bool receive_available(std::vector<uint8_t>& buffer, size_t size)
+	{
+		const size_t had = buffer.size();
+		buffer.resize(size);
+		const ssize_t received = ::recv(descriptor, buffer.data() + had, size - had, MSG_DONTWAIT);
+		if (received <= 0)
+		{
+			buffer.resize(had);
+			return received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+		}
+		buffer.resize(had + received);
+		return true;
+	}
+
+	/* false if it's not the header of our frame */
+	static bool read_header(const std::vector<uint8_t>& header, MessageType& type, uint32_t& length)
+	{
+		WireReader reader(header);
+		if (reader.get_u32() != MAGIC)
+		{
+			return false;
+		}
+		type = static_cast<MessageType>(reader.get_u8());
+		length = reader.get_u32();
+		return length <= MAX_PAYLOAD;
+	}
+};
+
+/* `unix:/path` or `tcp:host:port`, throws if it's neither */
+struct SocketAddress
+{
+	bool is_unix;
+	std::string path_or_host;
+	std::string port;
+
+	explicit SocketAddress(const std::string& address)
+	{
+		if (address.rfind("unix:", 0) == 0 && address.size() > 5)
+		{
+			is_unix = true;
+			path_or_host = address.substr(5);
+			if (path_or_host.size() >= sizeof(sockaddr_un::sun_path))
+			{
+				throw std::runtime_error("The socket path is too long: " + path_or_host);
+			}
+			return;
+		}
+		const auto port_separator = address.rfind(':');
+		if (address.rfind("tcp:", 0) == 0 && port_separator > 4)
+		{
+			is_unix = false;
+			path_or_host = address.substr(4, port_separator - 4);
+			port = address.substr(port_separator + 1);
+			return;
+		}
+		throw std::runtime_error("Address must be \"unix:/path\" or \"tcp:host:port\", got \"" + address + "\".");
+	}
+
+	sockaddr_un unix_address() const
+	{
+		sockaddr_un result{};
+		result.sun_family = AF_UNIX;
+		std::strncpy(result.sun_path, path_or_host.c_str(), sizeof(result.sun_path) - 1);
+		return result;
+	}
+};
+
+inline Socket listen_on(const std::string& address_text)
+{
+	const SocketAddress address(address_text);
+	if (address.is_unix)
+	{
+		Socket socket(::socket(AF_UNIX, SOCK_STREAM, 0));
+		const sockaddr_un unix_address = address.unix_address();
+		// the file of the previous run is in the way
+		::unlink(unix_address.sun_path);
+		if (!socket.is_open() || ::bind(socket.get(), reinterpret_cast<const sockaddr*>(&unix_address), sizeof(unix_address)) != 0
+			|| ::listen(socket.get(), 64) != 0)
+		{
+			throw std::runtime_error("Can't listen on " + address_text + ": " + std::strerror(errno));
+		}
+		return socket;
+	}
+
+	Socket socket(::socket(AF_INET, SOCK_STREAM, 0));
+	const int yes = 1;
+	setsockopt(socket.get(), SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+	sockaddr_in inet_address{};
+	inet_address.sin_family = AF_INET;
+	inet_address.sin_addr.s_addr = htonl(INADDR_ANY);
+	inet_address.sin_port = htons(static_cast<uint16_t>(std::stoi(address.port)));
+	if (!socket.is_open() || ::bind(socket.get(), reinterpret_cast<const sockaddr*>(&inet_address), sizeof(inet_address)) != 0
+		|| ::listen(socket.get(), 64) != 0)
+	{
+		throw std::runtime_error("Can't listen on " + address_text + ": " + std::strerror(errno));
+	}
+	return socket;
+}
+
+inline Socket connect_to(const std::string& address_text)
+{
+	const SocketAddress address(address_text);
+	if (address.is_unix)
+	{
+		Socket socket(::socket(AF_UNIX, SOCK_STREAM, 0));
+		const sockaddr_un unix_address = address.unix_address();
+		if (!socket.is_open() || ::connect(socket.get(), reinterpret_cast<const sockaddr*>(&unix_address), sizeof(unix_address)) != 0)
+		{
+			throw std::runtime_error("Can't connect to " + address_text + ": " + std::strerror(errno));
+		}
+		return socket;
+	}
+
+	addrinfo hints{};
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	addrinfo* addresses = nullptr;
+	if (getaddrinfo(address.path_or_host.c_str(), address.port.c_str(), &hints, &addresses) != 0)
+	{
+		throw std::runtime_error("Can't resolve " + address_text + ".");
+	}
+	Socket socket;
+	for (addrinfo* candidate = addresses; candidate != nullptr; candidate = candidate->ai_next)
+	{
+		Socket attempt(::socket(candidate->ai_family, candidate->ai_socktype, candidate->ai_protocol));
+		if (attempt.is_open() && ::connect(attempt.get(), candidate->ai_addr, candidate->ai_addrlen) == 0)
+		{
+			socket = std::move(attempt);
+			break;
+		}
+	}
+	freeaddrinfo(addresses);
+	if (!socket.is_open())
+	{
+		throw std::runtime_error("Can't connect to " + address_text + ".");
+	}
+	// migrations are small and we wait for the answer, don't let Nagle hold them back
+	const int yes = 1;
+	setsockopt(socket.get(), IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+	return socket;
+}
+
+/**
+* The worker's end: joins the coordinator in the constructor, then the GA calls `exchange()` every `migration_interval` generations.
+* If the coordinator is gone, the island is on its own from then on.
+*/
+class IslandWorkerLink : public MigrationLink
+{
+private:
+	Socket socket;
+	int tasks_count;
+
+	static constexpr int REPLY_TIMEOUT_SECONDS = 30;
+
+	void lose_coordinator()
+	{
+		if (socket.is_open())
+		{
+			std::cout << "Island " << island << ": lost the coordinator, going on alone.\n";
+			socket.close();
+		}
+	}
+
+public:
+	uint32_t island{ 0 };
+	uint64_t seed{ 0 };
+
+	IslandWorkerLink(const std::string& address, const SolutionTemplate& solution_template)
+		: socket(connect_to(address)), tasks_count(solution_template.get_graph().tasks_count())
+	{
+		socket.set_receive_timeout(REPLY_TIMEOUT_SECONDS);
+		WireWriter hello;
+		hello.put_u32(static_cast<uint32_t>(tasks_count));
+		hello.put_u64(problem_fingerprint(solution_template.get_graph()));
+		MessageType type;
+		std::vector<uint8_t> payload;
+		if (!socket.send_message(MessageType::Hello, hello) || !socket.receive_message(type, payload) || type != MessageType::Welcome)
+		{
+			throw std::runtime_error("The coordinator at " + address + " didn't accept this worker, is it the same problem file?");
+		}
+		WireReader reader(payload);
+		island = reader.get_u32();
+		seed = reader.get_u64();
+	}
+
+	std::vector<Chromosome> exchange(const std::vector<Chromosome>& emigrants, int best_total_runtime) override
+	{
+		if (!socket.is_open())
+		{
+			return {};
+		}
+		WireWriter migrants;
+		migrants.put_i32(best_total_runtime);
+		migrants.put_chromosomes(emigrants);
+		MessageType type;
+		std::vector<uint8_t> payload;
+		if (!socket.send_message(MessageType::Migrants, migrants) || !socket.receive_message(type, payload) || type != MessageType::Immigrants)
+		{
+			lose_coordinator();
+			return {};
+		}
+		try
+		{
+			WireReader reader(payload);
+			reader.get_i32(); // the best of all the islands, only for the coordinator's log for now
+			std::vector<Chromosome> immigrants = reader.get_chromosomes();
+			// a chromosome of another length is not for our problem, the fingerprint should have caught it already
+			std::erase_if(immigrants, [this](const Chromosome& chromosome) { return static_cast<int>(chromosome.size()) != tasks_count; });
+			return immigrants;
+		}
+		catch (const std::runtime_error&)
+		{
+			lose_coordinator();
+			return {};
+		}
+	}
+
+	/* the final best of the island, the coordinator may not have seen it yet */
+	void send_result(const Chromosome& best, int total_runtime)
+	{
+		if (!socket.is_open())
+		{
+			return;
+		}
+		WireWriter result;
+		result.put_i32(total_runtime);
+		result.put_chromosomes({ best });
+		socket.send_message(MessageType::Result, result);
+		socket.close();
+	}
+};
+
+/**
+* The coordinator's end: relays the migrants around the ring of the islands and keeps the best schedule of all of them.
+* Returns it once `islands` workers have joined and all of them are gone.
+*/
+inline Chromosome run_island_coordinator(SolutionTemplate& solution_template, const std::string& address, int islands, uint64_t seed)
+{
+	struct Island
+	{
+		Socket socket;
+		uint32_t number;
+		std::vector<Chromosome> latest_migrants{};
+		int best_total_runtime{ std::numeric_limits<int>::max() };
+	};
+
+	/* accepted, but its Hello is read as it arrives, so a slow or silent worker doesn't hold up the islands */
+	struct PendingWorker
+	{
+		Socket socket;
+		std::vector<uint8_t> hello;
+		std::chrono::steady_clock::time_point deadline;
+	};
+
+	const PrecedenceGraph& graph = solution_template.get_graph();
+	const uint64_t fingerprint = problem_fingerprint(graph);
+	Socket listener = listen_on(address);
+	std::cout << "Coordinator listening on " << address << ", waiting for " << islands << " islands.\n";
+
+	std::vector<Island> connected;
+	int joined{ 0 };
+	Chromosome best;
+	int best_total_runtime{ std::numeric_limits<int>::max() };
+
+	auto offer = [&](const Chromosome& chromosome, int total_runtime, uint32_t island) {
+		if (total_runtime < best_total_runtime && static_cast<int>(chromosome.size()) == graph.tasks_count())
+		{
+			// a worker's schedule and runtime are taken on trust only after we check them ourselves
+			solution_template.fill_start_times(chromosome);
+			if (!solution_template.is_feasible())
+			{
+				std::cout << "Refused an infeasible schedule from island " << island << "\n";
+				return;
+			}
+			const int checked_total_runtime = solution_template.total_runtime();
+			if (checked_total_runtime < best_total_runtime)
+			{
+				best_total_runtime = checked_total_runtime;
+				best = chromosome;
+				std::cout << "New best total runtime " << best_total_runtime << " from island " << island << "\n";
+			}
+		}
+	};
+
+	// a worker which hasn't sent its whole Hello by then is dropped
+	constexpr auto HELLO_TIMEOUT = std::chrono::seconds(10);
+	constexpr size_t HELLO_SIZE = Socket::HEADER_SIZE + 12;
+	std::vector<PendingWorker> pending;
+
+	auto welcome = [&](Socket socket, const std::vector<uint8_t>& hello) {
+		MessageType type;
+		uint32_t length;
+		const std::vector<uint8_t> payload(hello.begin() + Socket::HEADER_SIZE, hello.end());
+		WireReader reader(payload);
+		const bool is_accepted = joined < islands && Socket::read_header(hello, type, length) && type == MessageType::Hello && length == payload.size()
+			&& reader.get_u32() == static_cast<uint32_t>(graph.tasks_count()) && reader.get_u64() == fingerprint;
+		if (!is_accepted)
+		{
+			std::cout << "Refused a worker: not our protocol or a different problem.\n";
+			return;
+		}
+		const uint32_t number = static_cast<uint32_t>(joined++);
+		WireWriter welcome_payload;
+		welcome_payload.put_u32(number);
+		// every island searches its own way, keyed by the seed of the run and its number
+		CounterRandom random_engine(seed, 0, number, RandomStream::Island);
+		const uint64_t island_seed = random_engine();
+		welcome_payload.put_u64((island_seed << 32) | random_engine());
+		if (socket.send_message(MessageType::Welcome, welcome_payload))
+		{
+			std::cout << "Island " << number << " joined.\n";
+			socket.set_receive_timeout(10);
+			connected.push_back({ std::move(socket), number });
+		}
+	};
+
+	while (joined < islands || !connected.empty())
+	{
+		std::vector<pollfd> descriptors;
+		if (joined < islands)
+		{
+			descriptors.push_back({ listener.get(), POLLIN, 0 });
+		}
+		int timeout_milliseconds{ -1 };
+		const auto poll_time = std::chrono::steady_clock::now();
+		for (const auto& worker : pending)
+		{
+			descriptors.push_back({ worker.socket.get(), POLLIN, 0 });
+			const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(worker.deadline - poll_time).count();
+			const int left_milliseconds = static_cast<int>(std::max<decltype(left)>(left, 0));
+			timeout_milliseconds = timeout_milliseconds < 0 ? left_milliseconds : std::min(timeout_milliseconds, left_milliseconds);
+		}
+		for (const auto& island : connected)
+		{
+			descriptors.push_back({ island.socket.get(), POLLIN, 0 });
+		}
+		if (::poll(descriptors.data(), descriptors.size(), timeout_milliseconds) < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			throw std::runtime_error(std::string("poll failed: ") + std::strerror(errno));
+		}
+
+		// a worker or an island which joins now is not in `descriptors`, its turn comes with the next poll
+		const size_t polled_pending_count = pending.size();
+		const size_t polled_count = connected.size();
+		size_t descriptor_index{ 0 };
+		if (joined < islands)
+		{
+			if (descriptors[descriptor_index++].revents & POLLIN)
+			{
+				Socket socket(::accept(listener.get(), nullptr, nullptr));
+				if (socket.is_open())
+				{
+					pending.push_back({ std::move(socket), {}, std::chrono::steady_clock::now() + HELLO_TIMEOUT });
+				}
+			}
+		}
+
+		const auto now = std::chrono::steady_clock::now();
+		for (size_t i = 0, polled = 0; polled < polled_pending_count; ++polled, ++descriptor_index)
+		{
+			PendingWorker& worker = pending[i];
+			if (descriptors[descriptor_index].revents & (POLLIN | POLLHUP | POLLERR))
+			{
+				if (!worker.socket.receive_available(worker.hello, HELLO_SIZE))
+				{
+					pending.erase(pending.begin() + i);
+					continue;
+				}
+				if (worker.hello.size() == HELLO_SIZE)
+				{
+					welcome(std::move(worker.socket), worker.hello);
+					pending.erase(pending.begin() + i);
+					continue;
+				}
+			}
+			if (now >= worker.deadline)
+			{
+				std::cout << "Refused a worker: no Hello in time.\n";
+				pending.erase(pending.begin() + i);
+				continue;
+			}
+			++i;
+		}
+
+		for (size_t i = 0, polled = 0; polled < polled_count; ++polled, ++descriptor_index)
+		{
+			Island& island = connected[i];
+			const short events = descriptors[descriptor_index].revents;
+			if (!(events & (POLLIN | POLLHUP | POLLERR)))
+			{
+				++i;
+				continue;
+			}
+
+			MessageType type;
+			std::vector<uint8_t> payload;
+			bool is_alive = island.socket.receive_message(type, payload);
+			try
+			{
+				if (is_alive && type == MessageType::Migrants)
+				{
+					WireReader reader(payload);
+					island.best_total_runtime = reader.get_i32();
+					island.latest_migrants = reader.get_chromosomes();
+					if (!island.latest_migrants.empty())
+					{
+						offer(island.latest_migrants[0], island.best_total_runtime, island.number);
+					}
+
+					// the ring: every island gets the migrants of the next one still with us
+					WireWriter immigrants;
+					immigrants.put_i32(best_total_runtime);
+					immigrants.put_chromosomes(connected.size() > 1 ? connected[(i + 1) % connected.size()].latest_migrants : std::vector<Chromosome>{});
+					is_alive = island.socket.send_message(MessageType::Immigrants, immigrants);
+				}
+				else if (is_alive && type == MessageType::Result)
+				{
+					WireReader reader(payload);
+					const int total_runtime = reader.get_i32();
+					const auto result = reader.get_chromosomes();
+					if (!result.empty())
+					{
+						offer(result[0], total_runtime, island.number);
+					}
+					std::cout << "Island " << island.number << " finished with total runtime " << total_runtime << ".\n";
+					connected.erase(connected.begin() + i);
+					continue;
+				}
+				else
+				{
+					is_alive = false;
+				}
+			}
+			catch (const std::runtime_error&)
+			{
+				is_alive = false;
+			}
+
+			if (!is_alive)
+			{
+				// whatever it sent before is kept, the others go on without it
+				std::cout << "Island " << island.number << " is gone, its last best total runtime was " << island.best_total_runtime << ".\n";
+				connected.erase(connected.begin() + i);
+				continue;
+			}
+			++i;
+		}
+	}
+
+	if (best.empty())
+	{
+		throw std::runtime_error("No island reported a schedule.");
+	}
+	return best;
+}
+
+#else
+
+class IslandWorkerLink : public MigrationLink
+{
+public:
+	uint32_t island{ 0 };
+	uint64_t seed{ 0 };
+
+	IslandWorkerLink(const std::string&, const SolutionTemplate&)
+	{
+		throw std::runtime_error("The island model needs POSIX sockets, it's not available on Windows yet.");
+	}
+
+	std::vector<Chromosome> exchange(const std::vector<Chromosome>&, int) override
+	{
+		return {};
+	}
+
+	void send_result(const Chromosome&, int)
+	{
+	}
+};
+
+inline Chromosome run_island_coordinator(SolutionTemplate&, const std::string&, int, uint64_t)
+{
+	throw std::runtime_error("The island model needs POSIX sockets, it's not available on Windows yet.");
+}
+
+#endif
@@ -0,0 +1,379 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define NEC_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and clang need the permission to emit AVX2 in a single function, MSVC emits whatever intrinsics we use
+#if defined(NEC_KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define NEC_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define NEC_TARGET_AVX2
+#endif
+
+// for the plain loops which the compiler vectorizes itself: build an AVX2 clone next to the default one, picked at load time
+#if defined(NEC_KERNELS_X86) && defined(__GNUC__) && !defined(__clang__) && defined(__linux__)
+#define NEC_TARGET_CLONES __attribute__((target_clones("avx2", "default")))
+#else
+#define NEC_TARGET_CLONES
+#endif
+
+/**
+* Kernels for the chromosome-level genetic operators.
+*
+* Chromosome is just an array of ints (32-bit or 16-bit, see `BasicChromosome`), and the operators are simple loops over it,
+* so with SIMD they become as fast as the memory can deliver the genes.
+*
+* Every kernel has three variants: scalar (works everywhere), SSE2 (every x86-64 has it) and AVX2.
+* The variant is chosen once at runtime by the CPU we run on, see `kernel_table()`.
+* All of them are templates over the gene type, the only difference between the widths is in the `*Lanes` helpers below.
+*
+* - simd_swap_ranges: exchanges two ranges, the core of the 1-point and 2-point crossovers
+* - simd_blend: uniform crossover, gene i of the first child is taken from `right` where mask[i] is set and from `left` otherwise, the second child gets the rest
+* - simd_xor: XOR of every gene with a constant, the "uniform XOR" mutation
+* - simd_add_reflected: adds a delta to every gene, when the result goes below 0 the delta is subtracted instead (same correction as in `mutate_singular`)
+*/
+
+/* ------------ scalar ------------ */
+
+template <typename Gene>
+inline void swap_ranges_scalar(Gene* left, Gene* right, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		std::swap(left[i], right[i]);
+	}
+}
+
+template <typename Gene>
+inline void blend_scalar(const Gene* left, const Gene* right, const char* mask, Gene* offspring1, Gene* offspring2, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		offspring1[i] = mask[i] ? right[i] : left[i];
+		offspring2[i] = mask[i] ? left[i] : right[i];
+	}
+}
+
+template <typename Gene>
+inline void xor_scalar(Gene* values, size_t count, int constant)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		values[i] ^= static_cast<Gene>(constant);
+	}
+}
+
+template <typename Gene>
+inline void add_reflected_scalar(Gene* values, const Gene* deltas, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		const Gene sum = static_cast<Gene>(values[i] + deltas[i]);
+		values[i] = sum < 0 ? static_cast<Gene>(values[i] - deltas[i]) : sum;
+	}
+}
+
+#ifdef NEC_KERNELS_X86
+
+/* ------------ SSE2, 16 bytes at once ------------ */
+
+/* SSE2 has no blendv, so the selection is made from and/andnot/or */
+inline __m128i select_sse2(__m128i condition, __m128i if_true, __m128i if_false)
+{
+	return _mm_or_si128(_mm_and_si128(condition, if_true), _mm_andnot_si128(condition, if_false));
+}
+
+template <typename Gene> struct Sse2Lanes;
+
+template <> struct Sse2Lanes<int32_t>
+{
+	static constexpr size_t count = 4;
+	static __m128i set1(int value) { return _mm_set1_epi32(value); }
+	static __m128i add(__m128i a, __m128i b) { return _mm_add_epi32(a, b); }
+	static __m128i sub(__m128i a, __m128i b) { return _mm_sub_epi32(a, b); }
+	static __m128i greater(__m128i a, __m128i b) { return _mm_cmpgt_epi32(a, b); }
+	/* 0/1 mask bytes to all-zeroes/all-ones lanes */
+	static __m128i expand_mask(const char* mask)
+	{
+		int mask_bytes;
+		std::copy(mask, mask + 4, reinterpret_cast<char*>(&mask_bytes));
+		const __m128i zero = _mm_setzero_si128();
+		return _mm_cmpgt_epi32(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(mask_bytes), zero), zero), zero);
+	}
+};
+
+template <> struct Sse2Lanes<int16_t>
+{
+	static constexpr size_t count = 8;
+	static __m128i set1(int value) { return _mm_set1_epi16(static_cast<short>(value)); }
+	static __m128i add(__m128i a, __m128i b) { return _mm_add_epi16(a, b); }
+	static __m128i sub(__m128i a, __m128i b) { return _mm_sub_epi16(a, b); }
+	static __m128i greater(__m128i a, __m128i b) { return _mm_cmpgt_epi16(a, b); }
+	static __m128i expand_mask(const char* mask)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		return _mm_cmpgt_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(mask)), zero), zero);
+	}
+};
+
+inline __m128i load_sse2(const void* address)
+{
+	return _mm_loadu_si128(reinterpret_cast<const __m128i*>(address));
+}
+
+inline void store_sse2(void* address, __m128i value)
+{
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(address), value);
+}
+
+template <typename Gene>
+inline void swap_ranges_sse2(Gene* left, Gene* right, size_t count)
+{
+	constexpr size_t lanes = Sse2Lanes<Gene>::count;
+	size_t i = 0;
+	for (; i + lanes <= count; i += lanes)
+	{
+		__m128i a = load_sse2(left + i);
+		__m128i b = load_sse2(right + i);
+		store_sse2(left + i, b);
+		store_sse2(right + i, a);
+	}
+	swap_ranges_scalar(left + i, right + i, count - i);
+}
+
+template <typename Gene>
+inline void blend_sse2(const Gene* left, const Gene* right, const char* mask, Gene* offspring1, Gene* offspring2, size_t count)
+{
+	typedef Sse2Lanes<Gene> L;
+	size_t i = 0;
+	for (; i + L::count <= count; i += L::count)
+	{
+		__m128i take_right = L::expand_mask(mask + i);
+		__m128i a = load_sse2(left + i);
+		__m128i b = load_sse2(right + i);
+		store_sse2(offspring1 + i, select_sse2(take_right, b, a));
+		store_sse2(offspring2 + i, select_sse2(take_right, a, b));
+	}
+	blend_scalar(left + i, right + i, mask + i, offspring1 + i, offspring2 + i, count - i);
+}
+
+template <typename Gene>
+inline void xor_sse2(Gene* values, size_t count, int constant)
+{
+	typedef Sse2Lanes<Gene> L;
+	const __m128i pattern = L::set1(constant);
+	size_t i = 0;
+	for (; i + L::count <= count; i += L::count)
+	{
+		store_sse2(values + i, _mm_xor_si128(load_sse2(values + i), pattern));
+	}
+	xor_scalar(values + i, count - i, constant);
+}
+
+template <typename Gene>
+inline void add_reflected_sse2(Gene* values, const Gene* deltas, size_t count)
+{
+	typedef Sse2Lanes<Gene> L;
+	const __m128i zero = _mm_setzero_si128();
+	size_t i = 0;
+	for (; i + L::count <= count; i += L::count)
+	{
+		__m128i v = load_sse2(values + i);
+		__m128i d = load_sse2(deltas + i);
+		__m128i sum = L::add(v, d);
+		__m128i reflected = L::sub(v, d);
+		store_sse2(values + i, select_sse2(L::greater(zero, sum), reflected, sum));
+	}
+	add_reflected_scalar(values + i, deltas + i, count - i);
+}
+
+/* ------------ AVX2, 32 bytes at once ------------ */
+
+template <typename Gene> struct Avx2Lanes;
+
+template <> struct Avx2Lanes<int32_t>
+{
+	static constexpr size_t count = 8;
+	NEC_TARGET_AVX2 static __m256i set1(int value) { return _mm256_set1_epi32(value); }
+	NEC_TARGET_AVX2 static __m256i add(__m256i a, __m256i b) { return _mm256_add_epi32(a, b); }
+	NEC_TARGET_AVX2 static __m256i sub(__m256i a, __m256i b) { return _mm256_sub_epi32(a, b); }
+	NEC_TARGET_AVX2 static __m256i greater(__m256i a, __m256i b) { return _mm256_cmpgt_epi32(a, b); }
+	NEC_TARGET_AVX2 static __m256i expand_mask(const char* mask)
+	{
+		return _mm256_cmpgt_epi32(_mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(mask))), _mm256_setzero_si256());
+	}
+};
+
+template <> struct Avx2Lanes<int16_t>
+{
+	static constexpr size_t count = 16;
+	NEC_TARGET_AVX2 static __m256i set1(int value) { return _mm256_set1_epi16(static_cast<short>(value)); }
+	NEC_TARGET_AVX2 static __m256i add(__m256i a, __m256i b) { return _mm256_add_epi16(a, b); }
+	NEC_TARGET_AVX2 static __m256i sub(__m256i a, __m256i b) { return _mm256_sub_epi16(a, b); }
+	NEC_TARGET_AVX2 static __m256i greater(__m256i a, __m256i b) { return _mm256_cmpgt_epi16(a, b); }
+	NEC_TARGET_AVX2 static __m256i expand_mask(const char* mask)
+	{
+		return _mm256_cmpgt_epi16(_mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(mask))), _mm256_setzero_si256());
+	}
+};
+
+NEC_TARGET_AVX2 inline __m256i load_avx2(const void* address)
+{
+	return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(address));
+}
+
+NEC_TARGET_AVX2 inline void store_avx2(void* address, __m256i value)
+{
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(address), value);
+}
+
+template <typename Gene>
+NEC_TARGET_AVX2 inline void swap_ranges_avx2(Gene* left, Gene* right, size_t count)
+{
+	constexpr size_t lanes = Avx2Lanes<Gene>::count;
+	size_t i = 0;
+	for (; i + lanes <= count; i += lanes)
+	{
+		__m256i a = load_avx2(left + i);
+		__m256i b = load_avx2(right + i);
+		store_avx2(left + i, b);
+		store_avx2(right + i, a);
+	}
+	swap_ranges_scalar(left + i, right + i, count - i);
+}
+
+template <typename Gene>
+NEC_TARGET_AVX2 inline void blend_avx2(const Gene* left, const Gene* right, const char* mask, Gene* offspring1, Gene* offspring2, size_t count)
+{
+	typedef Avx2Lanes<Gene> L;
+	size_t i = 0;
+	for (; i + L::count <= count; i += L::count)
+	{
+		__m256i take_right = L::expand_mask(mask + i);
+		__m256i a = load_avx2(left + i);
+		__m256i b = load_avx2(right + i);
+		store_avx2(offspring1 + i, _mm256_blendv_epi8(a, b, take_right));
+		store_avx2(offspring2 + i, _mm256_blendv_epi8(b, a, take_right));
+	}
+	blend_scalar(left + i, right + i, mask + i, offspring1 + i, offspring2 + i, count - i);
+}
+
+template <typename Gene>
+NEC_TARGET_AVX2 inline void xor_avx2(Gene* values, size_t count, int constant)
+{
+	typedef Avx2Lanes<Gene> L;
+	const __m256i pattern = L::set1(constant);
+	size_t i = 0;
+	for (; i + L::count <= count; i += L::count)
+	{
+		store_avx2(values + i, _mm256_xor_si256(load_avx2(values + i), pattern));
+	}
+	xor_scalar(values + i, count - i, constant);
+}
+
+template <typename Gene>
+NEC_TARGET_AVX2 inline void add_reflected_avx2(Gene* values, const Gene* deltas, size_t count)
+{
+	typedef Avx2Lanes<Gene> L;
+	const __m256i zero = _mm256_setzero_si256();
+	size_t i = 0;
+	for (; i + L::count <= count; i += L::count)
+	{
+		__m256i v = load_avx2(values + i);
+		__m256i d = load_avx2(deltas + i);
+		__m256i sum = L::add(v, d);
+		__m256i reflected = L::sub(v, d);
+		store_avx2(values + i, _mm256_blendv_epi8(sum, reflected, L::greater(zero, sum)));
+	}
+	add_reflected_scalar(values + i, deltas + i, count - i);
+}
+
+inline bool cpu_supports_avx2()
+{
+#if defined(_MSC_VER)
+	int registers[4];
+	__cpuid(registers, 0);
+	if (registers[0] < 7)
+	{
+		return false;
+	}
+	__cpuidex(registers, 7, 0);
+	const bool has_avx2 = (registers[1] & (1 << 5)) != 0;
+	// the OS must also save the upper halves of the registers
+	__cpuid(registers, 1);
+	const bool has_osxsave = (registers[2] & (1 << 27)) != 0;
+	return has_avx2 && has_osxsave && (_xgetbv(0) & 0x6) == 0x6;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // NEC_KERNELS_X86
+
+/* ------------ dispatch ------------ */
+
+template <typename Gene>
+struct KernelTable
+{
+	std::string name;
+	void (*swap_ranges)(Gene*, Gene*, size_t);
+	void (*blend)(const Gene*, const Gene*, const char*, Gene*, Gene*, size_t);
+	void (*xor_constant)(Gene*, size_t, int);
+	void (*add_reflected)(Gene*, const Gene*, size_t);
+};
+
+template <typename Gene>
+inline KernelTable<Gene> select_kernels()
+{
+#ifdef NEC_KERNELS_X86
+	if (cpu_supports_avx2())
+	{
+		return { "avx2", swap_ranges_avx2<Gene>, blend_avx2<Gene>, xor_avx2<Gene>, add_reflected_avx2<Gene> };
+	}
+	return { "sse2", swap_ranges_sse2<Gene>, blend_sse2<Gene>, xor_sse2<Gene>, add_reflected_sse2<Gene> };
+#else
+	return { "scalar", swap_ranges_scalar<Gene>, blend_scalar<Gene>, xor_scalar<Gene>, add_reflected_scalar<Gene> };
+#endif
+}
+
+/* chosen once per gene type, on the first use */
+template <typename Gene = int>
+inline const KernelTable<Gene>& kernel_table()
+{
+	static const KernelTable<Gene> table = select_kernels<Gene>();
+	return table;
+}
+
+template <typename Gene>
+inline void simd_swap_ranges(Gene* left, Gene* right, size_t count)
+{
+	kernel_table<Gene>().swap_ranges(left, right, count);
+}
+
+template <typename Gene>
+inline void simd_blend(const Gene* left, const Gene* right, const char* mask, Gene* offspring1, Gene* offspring2, size_t count)
+{
+	kernel_table<Gene>().blend(left, right, mask, offspring1, offspring2, count);
+}
+
+template <typename Gene>
+inline void simd_xor(Gene* values, size_t count, int constant)
+{
+	kernel_table<Gene>().xor_constant(values, count, constant);
+}
+
+template <typename Gene>
+inline void simd_add_reflected(Gene* values, const Gene* deltas, size_t count)
+{
+	kernel_table<Gene>().add_reflected(values, deltas, count);
+}
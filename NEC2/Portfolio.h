@@ -0,0 +1,339 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common.h"
+#include "Random.h"
+#include "SolutionTemplate.h"
+#include "GeneticAlgorithm.h"
+#include "SimulatedAnnealing.h"
+
+/**
+* Several solvers racing on the same instance, each on its own share of the threads.
+*
+* Which GA configuration is the best depends on the instance (see outputs/: 2-point/pure/xor wins on one, 1-point/tainted/singular on another),
+* so instead of tuning it by hand we run a few of them side by side and let the results decide.
+*
+* The run goes in rounds of `round_time` seconds. In every round the members run at the same time, each with the threads it was given,
+* and all of them work on the best schedule of the portfolio:
+* - a GA gets it as an immigrant through the same `MigrationLink` the islands use, and offers its own best there
+*   every `migration_interval` generations, so the others see it already during the round,
+* - the annealing starts its walk from it, on more than one thread it becomes the parallel tempering with a replica per thread.
+* After the round every member scores the improvement of the best makespan it made, per thread, and the threads of the next round
+* are dealt out in proportion to these scores (older rounds count half as much every round), see `allocate_portfolio_threads()`.
+* A member which hasn't run yet gets the highest score, so everybody is tried before the threads go to the winners.
+*
+* The GAs start from a new population every round, a round should be long enough for a few dozen generations.
+*/
+
+/* the best schedule of the portfolio, the members read and offer it from their threads */
+class PortfolioBoard
+{
+private:
+	mutable std::mutex mutex;
+	Chromosome best;
+	int best_total_runtime{ std::numeric_limits<int>::max() };
+
+public:
+	/* returns true if the schedule is the new best */
+	bool offer(const Chromosome& chromosome, int total_runtime)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (total_runtime >= best_total_runtime)
+		{
+			return false;
+		}
+		best = chromosome;
+		best_total_runtime = total_runtime;
+		return true;
+	}
+
+	std::pair<Chromosome, int> get() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return { best, best_total_runtime };
+	}
+
+	int get_total_runtime() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return best_total_runtime;
+	}
+};
+
+/* the migrations of a GA member go to the board instead of the other islands */
+class PortfolioLink : public MigrationLink
+{
+private:
+	PortfolioBoard& board;
+
+public:
+	explicit PortfolioLink(PortfolioBoard& board) : board(board)
+	{
+	}
+
+	std::vector<Chromosome> exchange(const std::vector<Chromosome>& emigrants, int best_total_runtime) override
+	{
+		// the emigrants come best first and the runtime is of the first one
+		if (!emigrants.empty())
+		{
+			board.offer(emigrants.front(), best_total_runtime);
+		}
+		auto [best, total_runtime] = board.get();
+		if (total_runtime < best_total_runtime)
+		{
+			return { std::move(best) };
+		}
+		return {};
+	}
+};
+
+struct PortfolioSettings
+{
+	std::string members; // comma-separated, "crossover/selection/mutation/decoder" of a GA or "annealing"
+	int threads; // shared by all the members
+	double round_time; // in seconds
+	int rounds;
+	double time_limit; // in seconds, 0 means no limit, checked after every round
+	GeneticSettings genetic; // the threads, the time limit and the migration link are set by the portfolio
+	AnnealingSettings annealing; // the time limit is set by the portfolio
+	int tempering_exchange_interval; // when the annealing has more than one thread
+};
+
+struct PortfolioMember
+{
+	std::string name;
+	const GeneticSolver* genetic_solver; // nullptr for the annealing
+	SolutionTemplate solution_template; // every member has its own, the solvers write the start times into it
+	double score{ 0.0 }; // improvements of the best makespan per thread, halved every round
+	int last_round{ -1 };
+	int threads{ 0 };
+	int rounds_run{ 0 };
+	int rounds_improved{ 0 }; // rounds in which it made the best schedule of the portfolio better
+	double thread_seconds{ 0.0 };
+	Chromosome result{};
+	int result_total_runtime{ 0 };
+};
+
+/* throws if a member is neither the annealing nor a known GA configuration */
+inline std::vector<std::unique_ptr<PortfolioMember>> parse_portfolio_members(const std::string& members, const SolutionTemplate& solution_template)
+{
+	std::vector<std::unique_ptr<PortfolioMember>> result;
+	std::istringstream list(members);
+	std::string member;
+	while (std::getline(list, member, ','))
+	{
+		member.erase(0, member.find_first_not_of(" \t"));
+		member.erase(member.find_last_not_of(" \t") + 1);
+		if (member.empty())
+		{
+			continue;
+		}
+		const GeneticSolver* genetic_solver{ nullptr };
+		if (member != "annealing")
+		{
+			std::vector<std::string> policies;
+			std::istringstream names(member);
+			std::string name;
+			while (std::getline(names, name, '/'))
+			{
+				policies.push_back(name);
+			}
+			if (policies.size() != 4)
+			{
+				throw std::runtime_error("Portfolio member \"" + member + "\" is neither \"annealing\" nor \"crossover/selection/mutation/decoder\".");
+			}
+			genetic_solver = &find_genetic_solver(policies[0], policies[1], policies[2], policies[3]);
+		}
+		result.push_back(std::make_unique<PortfolioMember>(PortfolioMember{ member, genetic_solver, solution_template }));
+	}
+	if (result.empty())
+	{
+		throw std::runtime_error("The portfolio has no members.");
+	}
+	return result;
+}
+
+/*
+ * Deals the threads out for the next round, one at a time to the member with the highest score per thread it would have
+ * (the longest waiting first among the equal ones), so the shares end up proportional to the scores and a member can get none.
+ * Only a member which hasn't run for as many rounds as there are members gets its thread first, whatever its score,
+ * so the losers are tried again now and then and a winner which stopped improving loses its threads.
+ */
+inline void allocate_portfolio_threads(std::vector<std::unique_ptr<PortfolioMember>>& members, int threads, int round)
+{
+	// the members which haven't run yet count as good as the best of the others
+	double best_score{ 0.0 };
+	for (const auto& member : members)
+	{
+		if (member->last_round >= 0)
+		{
+			best_score = std::max(best_score, member->score);
+		}
+	}
+	std::vector<double> scores;
+	for (const auto& member : members)
+	{
+		// a tiny base keeps the members without any improvement in the deal, evenly
+		scores.push_back((member->last_round >= 0 ? member->score : best_score) + 1e-9);
+		member->threads = 0;
+	}
+	const int members_count = static_cast<int>(members.size());
+
+	int longest_waiting{ 0 };
+	for (int i = 1; i < members_count; ++i)
+	{
+		if (members[i]->last_round < members[longest_waiting]->last_round)
+		{
+			longest_waiting = i;
+		}
+	}
+	int spare = threads;
+	if (members[longest_waiting]->last_round >= 0 && round - members[longest_waiting]->last_round > members_count)
+	{
+		members[longest_waiting]->threads = 1;
+		--spare;
+	}
+
+	for (; spare > 0; --spare)
+	{
+		int chosen{ 0 };
+		for (int i = 1; i < members_count; ++i)
+		{
+			const double share = scores[i] / (members[i]->threads + 1);
+			const double chosen_share = scores[chosen] / (members[chosen]->threads + 1);
+			if (share > chosen_share || (share == chosen_share && members[i]->last_round < members[chosen]->last_round))
+			{
+				chosen = i;
+			}
+		}
+		++members[chosen]->threads;
+	}
+}
+
+/* runs one member for one round from the best schedule so far, leaves its result in the member */
+inline void run_portfolio_member(PortfolioMember& member, PortfolioBoard& board, const PortfolioSettings& settings, double round_time, uint64_t seed)
+{
+	if (member.genetic_solver != nullptr)
+	{
+		PortfolioLink link(board);
+		GeneticSettings genetic_settings = settings.genetic;
+		genetic_settings.threads = member.threads;
+		genetic_settings.time_limit = round_time;
+		genetic_settings.migration_link = &link;
+		genetic_settings.is_quiet = true;
+		member.result = member.genetic_solver->solve(member.solution_template, genetic_settings, seed);
+	}
+	else
+	{
+		AnnealingSettings annealing_settings = settings.annealing;
+		annealing_settings.time_limit = round_time;
+		annealing_settings.is_quiet = true;
+		const Chromosome initial = board.get().first;
+		member.result = member.threads == 1
+			? solve_using_simulated_annealing(member.solution_template, initial, annealing_settings, seed)
+			: solve_using_parallel_tempering(member.solution_template, initial, annealing_settings, member.threads, settings.tempering_exchange_interval, seed);
+	}
+	member.solution_template.fill_start_times(member.result);
+	member.result_total_runtime = member.solution_template.total_runtime();
+}
+
+/**
+* Races the members of the portfolio, see above.
+* `initial` is the schedule the annealing starts from before anybody has found a better one.
+* Returns the best schedule of all the members.
+*/
+inline Chromosome solve_using_portfolio(SolutionTemplate& solution_template, const Chromosome& initial, const PortfolioSettings& settings, uint64_t seed)
+{
+	auto members = parse_portfolio_members(settings.members, solution_template);
+	PortfolioBoard board;
+	solution_template.fill_start_times(initial);
+	board.offer(initial, solution_template.total_runtime());
+
+	const Deadline deadline(settings.time_limit);
+	const auto start = std::chrono::steady_clock::now();
+	const int lowest_bound = solution_template.absolute_lowest_bound();
+	std::cout << "Portfolio of " << members.size() << " members on " << settings.threads << " threads, rounds of " << settings.round_time << " s.\n";
+
+	for (int round = 0; round < settings.rounds; ++round)
+	{
+		allocate_portfolio_threads(members, settings.threads, round);
+
+		// the last round doesn't go past the time limit
+		double round_time = settings.round_time;
+		if (settings.time_limit > 0.0)
+		{
+			const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			round_time = std::min(round_time, std::max(settings.time_limit - elapsed, 0.01));
+		}
+
+		const int total_runtime_before = board.get_total_runtime();
+		std::vector<std::thread> threads;
+		for (size_t i = 0; i < members.size(); ++i)
+		{
+			PortfolioMember& member = *members[i];
+			if (member.threads == 0)
+			{
+				continue;
+			}
+			CounterRandom random_engine(seed, round, static_cast<uint32_t>(i), RandomStream::Portfolio);
+			const uint64_t member_seed = (static_cast<uint64_t>(random_engine()) << 32) | random_engine();
+			threads.emplace_back(run_portfolio_member, std::ref(member), std::ref(board), std::cref(settings), round_time, member_seed);
+		}
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+
+		// the scores are per thread, so a member doesn't win the next round just because it had more threads in this one
+		std::ostringstream shares;
+		for (size_t i = 0; i < members.size(); ++i)
+		{
+			PortfolioMember& member = *members[i];
+			if (member.threads == 0)
+			{
+				continue;
+			}
+			// the first round starts from a random schedule which everybody improves by a lot, it only sets the bar
+			const double improvement = round == 0 ? 0.0 : std::max(0, total_runtime_before - member.result_total_runtime);
+			member.score = member.score / 2 + improvement / member.threads;
+			member.last_round = round;
+			++member.rounds_run;
+			member.thread_seconds += round_time * member.threads;
+			member.rounds_improved += improvement > 0;
+			board.offer(member.result, member.result_total_runtime);
+			shares << "\t" << member.name << ": " << member.threads << " threads, " << member.result_total_runtime;
+		}
+		const int total_runtime = board.get_total_runtime();
+		std::cout << "round " << round << "\tbest makespan: " << total_runtime << shares.str() << "\n";
+
+		if (total_runtime <= lowest_bound)
+		{
+			std::cout << "The lower bound is reached.\n";
+			break;
+		}
+		if (deadline.is_over())
+		{
+			std::cout << "Time limit reached at round " << round << ".\n";
+			break;
+		}
+	}
+
+	std::cout << "Portfolio members:\n";
+	for (const auto& member : members)
+	{
+		std::cout << "  " << member->name << ": " << member->rounds_run << " rounds, " << member->thread_seconds << " thread-seconds, improved the best in "
+			<< member->rounds_improved << " rounds\n";
+	}
+	return board.get().first;
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "common.h"
+
+/**
+* Immutable disjunctive graph of the problem in the compressed sparse row form.
+*
+* Every job and every machine is a contiguous range in one flat array, described by the offsets array:
+* tasks of the job `j` are `job_tasks[job_offsets[j]]` .. `job_tasks[job_offsets[j + 1] - 1]`, in the order of the sequence numbers,
+* and the same for the machines with `machine_offsets` and `machine_tasks`.
+*
+* On top of that every task knows its neighbours in the job directly, so walking along the job is a single array lookup.
+*
+* It replaces the vectors of vectors we had before: one heap block per job and per machine and pointer chasing in every loop.
+* For la40 the whole thing is a few kilobytes and sits in L1.
+*/
+struct PrecedenceGraph
+{
+	/* per task */
+	std::vector<int> lengths;
+	std::vector<int> job_of_task;
+	std::vector<int> machine_of_task;
+	std::vector<int> job_predecessor; // -1 if the task is the first in its job
+	std::vector<int> job_successor; // -1 if the task is the last in its job
+
+	/* per job, CSR */
+	std::vector<int> job_offsets;
+	std::vector<int /* index in tasks */> job_tasks;
+
+	/* per machine, CSR, tasks in the order of their indices */
+	std::vector<int> machine_offsets;
+	std::vector<int /* index in tasks */> machine_tasks;
+
+	int tasks_count() const
+	{
+		return lengths.size();
+	}
+
+	int jobs_count() const
+	{
+		return job_offsets.size() - 1;
+	}
+
+	int machines_count() const
+	{
+		return machine_offsets.size() - 1;
+	}
+
+	/**
+	* Builds the graph from the list of tasks.
+	* Tasks of the same job must be listed in the order of their sequence numbers, that's how `add_job` creates them.
+	*/
+	static PrecedenceGraph build(const std::vector<Task>& tasks)
+	{
+		PrecedenceGraph graph;
+		const int tasks_count = tasks.size();
+
+		int jobs_count = 0;
+		int machines_count = 0;
+		for (const auto& task : tasks)
+		{
+			jobs_count = std::max(jobs_count, std::get<0>(task) + 1);
+			machines_count = std::max(machines_count, std::get<1>(task) + 1);
+		}
+
+		graph.lengths.resize(tasks_count);
+		graph.job_of_task.resize(tasks_count);
+		graph.machine_of_task.resize(tasks_count);
+		graph.job_predecessor.assign(tasks_count, -1);
+		graph.job_successor.assign(tasks_count, -1);
+		for (int i = 0; i < tasks_count; ++i)
+		{
+			graph.job_of_task[i] = std::get<0>(tasks[i]);
+			graph.machine_of_task[i] = std::get<1>(tasks[i]);
+			graph.lengths[i] = std::get<3>(tasks[i]);
+		}
+
+		graph.job_offsets = counting_offsets(graph.job_of_task, jobs_count);
+		graph.job_tasks = counting_sort(graph.job_of_task, graph.job_offsets);
+		graph.machine_offsets = counting_offsets(graph.machine_of_task, machines_count);
+		graph.machine_tasks = counting_sort(graph.machine_of_task, graph.machine_offsets);
+
+		for (int job_id = 0; job_id < jobs_count; ++job_id)
+		{
+			for (int i = graph.job_offsets[job_id] + 1; i < graph.job_offsets[job_id + 1]; ++i)
+			{
+				graph.job_predecessor[graph.job_tasks[i]] = graph.job_tasks[i - 1];
+				graph.job_successor[graph.job_tasks[i - 1]] = graph.job_tasks[i];
+			}
+		}
+
+		return graph;
+	}
+
+private:
+	static std::vector<int> counting_offsets(const std::vector<int>& keys, int keys_count)
+	{
+		std::vector<int> offsets(keys_count + 1, 0);
+		for (const auto key : keys)
+		{
+			++offsets[key + 1];
+		}
+		for (int i = 0; i < keys_count; ++i)
+		{
+			offsets[i + 1] += offsets[i];
+		}
+		return offsets;
+	}
+
+	/* stable, so the tasks of every key stay in the order of their indices */
+	static std::vector<int> counting_sort(const std::vector<int>& keys, const std::vector<int>& offsets)
+	{
+		std::vector<int> result(keys.size());
+		std::vector<int> next_position(offsets.begin(), offsets.end() - 1);
+		for (int i = 0; i < static_cast<int>(keys.size()); ++i)
+		{
+			result[next_position[keys[i]]++] = i;
+		}
+		return result;
+	}
+};
@@ -0,0 +1,318 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/**
+* Random number generation for the solvers.
+*
+* `std::mt19937` is big (2.5 KB of state) and slow-ish, and `std::uniform_int_distribution` costs a lot per call,
+* which adds up when we call it for every specimen in every generation.
+*
+* Here we have two small engines:
+* - xoshiro256** (Blackman & Vigna), 32 bytes of state, 64-bit output
+* - PCG32 (O'Neill), 16 bytes of state, 32-bit output
+* Both satisfy UniformRandomBitGenerator, so they work with the standard distributions too.
+*
+* Bounded integers are made with Lemire's multiply-shift method (with rejection, so it's unbiased):
+* one multiplication instead of a division in almost all the cases.
+* The bulk functions fill a whole array at once, the 64-bit engine gives two 32-bit numbers per call.
+*
+* Every worker (thread, annealing walker) must have its own engine, they are not thread-safe.
+*/
+
+/* used to expand one seed into the full state of an engine */
+inline uint64_t splitmix64(uint64_t& state)
+{
+	uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+class Xoshiro256StarStar
+{
+private:
+	uint64_t state[4];
+
+	static uint64_t rotate_left(uint64_t x, int k)
+	{
+		return (x << k) | (x >> (64 - k));
+	}
+
+public:
+	typedef uint64_t result_type;
+
+	explicit Xoshiro256StarStar(uint64_t seed = 0)
+	{
+		for (auto& word : state)
+		{
+			word = splitmix64(seed);
+		}
+	}
+
+	static constexpr result_type min()
+	{
+		return 0;
+	}
+
+	static constexpr result_type max()
+	{
+		return std::numeric_limits<result_type>::max();
+	}
+
+	result_type operator()()
+	{
+		const uint64_t result = rotate_left(state[1] * 5, 7) * 9;
+		const uint64_t t = state[1] << 17;
+		state[2] ^= state[0];
+		state[3] ^= state[1];
+		state[1] ^= state[2];
+		state[0] ^= state[3];
+		state[2] ^= t;
+		state[3] = rotate_left(state[3], 45);
+		return result;
+	}
+};
+
+class Pcg32
+{
+private:
+	uint64_t state;
+	uint64_t increment;
+
+public:
+	typedef uint32_t result_type;
+
+	explicit Pcg32(uint64_t seed = 0)
+	{
+		state = splitmix64(seed);
+		increment = splitmix64(seed) | 1; // must be odd
+	}
+
+	static constexpr result_type min()
+	{
+		return 0;
+	}
+
+	static constexpr result_type max()
+	{
+		return std::numeric_limits<result_type>::max();
+	}
+
+	result_type operator()()
+	{
+		const uint64_t old_state = state;
+		state = old_state * 6364136223846793005ULL + increment;
+		const uint32_t xor_shifted = static_cast<uint32_t>(((old_state >> 18) ^ old_state) >> 27);
+		const uint32_t rotation = static_cast<uint32_t>(old_state >> 59);
+		return (xor_shifted >> rotation) | (xor_shifted << ((32 - rotation) & 31));
+	}
+};
+
+/**
+* Counter-based generator: Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3").
+*
+* There's no state to carry from one call to the next: the output is a bijection of (key, counter).
+* We use the seed as the key and put the "coordinates" of the random decision into the counter:
+* (generation, specimen index, operator, block number).
+* So the numbers used to breed specimen 42 in generation 7 are always the same,
+* no matter which thread breeds it and in which order, and the runs are bit-identical on 1 or 64 threads.
+*/
+enum class RandomStream : uint32_t
+{
+	Initialisation,
+	Crossover,
+	Mutation,
+	MutationMask,
+	Diversity, // replacement of the duplicates
+	Tournament, // parents of the steady-state GA
+	Island, // seeds of the islands of the multi-process GA
+	Portfolio, // seeds of the members of the portfolio, one per round
+	Batch, // seeds of the instances of the batch and of the requests to the server
+};
+
+class CounterRandom
+{
+private:
+	uint32_t key[2];
+	uint32_t counter[4];
+	uint32_t block[4];
+	int used_in_block{ 4 };
+
+	static void multiply_high_low(uint32_t a, uint32_t b, uint32_t& high, uint32_t& low)
+	{
+		const uint64_t product = static_cast<uint64_t>(a) * b;
+		high = static_cast<uint32_t>(product >> 32);
+		low = static_cast<uint32_t>(product);
+	}
+
+	void generate_block()
+	{
+		uint32_t c[4] = { counter[0], counter[1], counter[2], counter[3] };
+		uint32_t k[2] = { key[0], key[1] };
+		for (int round = 0; round < 10; ++round)
+		{
+			uint32_t high0, low0, high1, low1;
+			multiply_high_low(0xD2511F53u, c[0], high0, low0);
+			multiply_high_low(0xCD9E8D57u, c[2], high1, low1);
+			c[0] = high1 ^ c[1] ^ k[0];
+			c[1] = low1;
+			c[2] = high0 ^ c[3] ^ k[1];
+			c[3] = low0;
+			k[0] += 0x9E3779B9u;
+			k[1] += 0xBB67AE85u;
+		}
+		for (int i = 0; i < 4; ++i)
+		{
+			block[i] = c[i];
+		}
+		++counter[0];
+		used_in_block = 0;
+	}
+
+public:
+	typedef uint32_t result_type;
+
+	CounterRandom(uint64_t seed, uint32_t generation, uint32_t specimen_index, RandomStream stream)
+		: key{ static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32) },
+		counter{ 0, specimen_index, generation, static_cast<uint32_t>(stream) },
+		block{ 0, 0, 0, 0 }
+	{
+	}
+
+	static constexpr result_type min()
+	{
+		return 0;
+	}
+
+	static constexpr result_type max()
+	{
+		return std::numeric_limits<result_type>::max();
+	}
+
+	result_type operator()()
+	{
+		if (used_in_block == 4)
+		{
+			generate_block();
+		}
+		return block[used_in_block++];
+	}
+};
+
+/* the engine used by the solvers, switch to `Pcg32` here if you want to compare */
+typedef Xoshiro256StarStar RandomEngine;
+
+/*
+ * Source of 32-bit random words.
+ * For a 64-bit engine every call gives us two of them, so we keep the second half for the next request.
+ */
+template <class Engine>
+class RandomWords
+{
+private:
+	Engine& engine;
+	uint64_t buffered{ 0 };
+	bool has_buffered{ false };
+
+public:
+	explicit RandomWords(Engine& engine) : engine(engine) {}
+
+	uint32_t next()
+	{
+		if constexpr (sizeof(typename Engine::result_type) == 8)
+		{
+			if (has_buffered)
+			{
+				has_buffered = false;
+				return static_cast<uint32_t>(buffered);
+			}
+			buffered = engine();
+			has_buffered = true;
+			return static_cast<uint32_t>(buffered >> 32);
+		}
+		else
+		{
+			return static_cast<uint32_t>(engine());
+		}
+	}
+};
+
+/*
+ * Lemire's nearly divisionless method: the high half of word * range is uniform in [0, range)
+ * once we reject the few words which fall into the biased low part.
+ */
+template <class Words>
+inline uint32_t lemire_below(Words& words, uint32_t range)
+{
+	uint64_t product = static_cast<uint64_t>(words.next()) * range;
+	uint32_t low = static_cast<uint32_t>(product);
+	if (low < range)
+	{
+		// the only place with a division, taken with probability range / 2^32
+		const uint32_t threshold = (0u - range) % range;
+		while (low < threshold)
+		{
+			product = static_cast<uint64_t>(words.next()) * range;
+			low = static_cast<uint32_t>(product);
+		}
+	}
+	return static_cast<uint32_t>(product >> 32);
+}
+
+/* uniform integer in [0, range) */
+template <class Engine>
+inline uint32_t random_below(Engine& engine, uint32_t range)
+{
+	RandomWords<Engine> words(engine);
+	return lemire_below(words, range);
+}
+
+/* uniform integer in [min_value, max_value], both inclusive like in `std::uniform_int_distribution` */
+template <class Engine>
+inline int random_between(Engine& engine, int min_value, int max_value)
+{
+	return min_value + static_cast<int>(random_below(engine, static_cast<uint32_t>(max_value - min_value + 1)));
+}
+
+/* uniform double in [0, 1) */
+template <class Engine>
+inline double random_unit(Engine& engine)
+{
+	if constexpr (sizeof(typename Engine::result_type) == 8)
+	{
+		return (engine() >> 11) * 0x1.0p-53;
+	}
+	else
+	{
+		return engine() * 0x1.0p-32;
+	}
+}
+
+/* fills the whole array with uniform integers in [min_value, max_value] */
+template <class Engine, class Value>
+inline void fill_between(Engine& engine, std::vector<Value>& values, int min_value, int max_value)
+{
+	RandomWords<Engine> words(engine);
+	const uint32_t range = static_cast<uint32_t>(max_value - min_value + 1);
+	for (auto& value : values)
+	{
+		value = static_cast<Value>(min_value + static_cast<int>(lemire_below(words, range)));
+	}
+}
+
+/*
+ * Fills the mask with 1 with the probability of `percent` / 100, 0 otherwise.
+ * This is the "should we mutate this specimen" decision for the whole population at once.
+ */
+template <class Engine>
+inline void fill_mask(Engine& engine, std::vector<char>& mask, int percent)
+{
+	RandomWords<Engine> words(engine);
+	for (auto& flag : mask)
+	{
+		flag = lemire_below(words, 100) < static_cast<uint32_t>(percent);
+	}
+}
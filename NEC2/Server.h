@@ -0,0 +1,255 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "common.h"
+#include "Random.h"
+#include "SolutionTemplate.h"
+#include "Batch.h"
+#include "Island.h"
+
+/**
+* The solver as a long-running server.
+*
+* Starting `./main` for every schedule pays the process start, the threads and the warm-up of the heap every time,
+* for the small instances that's more than the search itself. The server is started once (`--serve stdin` or `--serve unix:/path`,
+* `tcp:host:port` works too) and solves the requests one after another: the pool of the GA (see `GeneticSettings::scheduler`)
+* stays up between them and the allocator reuses the memory of the previous populations.
+*
+* The requests and the replies are text framed by lengths, so they can be typed into the stdin or sent with a few lines of any language:
+*   SOLVE <time limit in seconds> <length in bytes>\n<the problem, in the format of the problem files, exactly that many bytes>
+*   QUIT\n
+* and the server replies to SOLVE with
+*   SOLVED <total runtime> <lower bound> <seconds> <tasks count>\n<start times of the tasks in the order of the problem, separated by spaces>\n
+*   ERROR <message>\n
+* QUIT stops the server. With a socket the clients come one at a time, each of them can send any number of requests.
+* With `stdin` the replies go to the stdout, so the log of the server goes to the stderr in both cases.
+*/
+
+/* the solver of one request: template of the problem, time limit, seed */
+typedef std::function<Chromosome(SolutionTemplate&, double, uint64_t)> ServerSolver;
+
+#ifndef _WIN32
+
+/* the requests come from `input` and the replies go to `output`, the same socket or stdin and stdout */
+class ServerStream
+{
+private:
+	int input;
+	int output;
+	std::string buffer; // read but not taken yet
+
+	static constexpr size_t MAX_REQUEST = 64u << 20;
+
+	/* false at the end of the input */
+	bool fill()
+	{
+		char chunk[1 << 16];
+		const ssize_t received = ::read(input, chunk, sizeof(chunk));
+		if (received <= 0)
+		{
+			return false;
+		}
+		buffer.append(chunk, received);
+		return true;
+	}
+
+public:
+	ServerStream(int input, int output) : input(input), output(output)
+	{
+	}
+
+	/* the line without the '\n', false at the end of the input or if the line is too long to be ours */
+	bool read_line(std::string& line)
+	{
+		size_t end;
+		while ((end = buffer.find('\n')) == std::string::npos)
+		{
+			if (buffer.size() > MAX_REQUEST || !fill())
+			{
+				return false;
+			}
+		}
+		line = buffer.substr(0, end);
+		if (!line.empty() && line.back() == '\r')
+		{
+			line.pop_back();
+		}
+		buffer.erase(0, end + 1);
+		return true;
+	}
+
+	bool read_bytes(size_t size, std::string& bytes)
+	{
+		if (size > MAX_REQUEST)
+		{
+			return false;
+		}
+		while (buffer.size() < size)
+		{
+			if (!fill())
+			{
+				return false;
+			}
+		}
+		bytes = buffer.substr(0, size);
+		buffer.erase(0, size);
+		return true;
+	}
+
+	/* false if the client is gone */
+	bool write(const std::string& text)
+	{
+		const char* data = text.data();
+		size_t size = text.size();
+		while (size > 0)
+		{
+			const ssize_t sent = ::write(output, data, size);
+			if (sent <= 0)
+			{
+				return false;
+			}
+			data += sent;
+			size -= sent;
+		}
+		return true;
+	}
+};
+
+/* solves one problem given as text, returns the reply */
+inline std::string solve_request(const std::string& problem, double time_limit, const ServerSolver& solve, uint64_t seed)
+{
+	SolutionTemplate solution_template;
+	std::istringstream problem_stream(problem);
+	// a malformed problem is rejected here with its ERROR reply, the daemon carries on with the next request
+	read_problem(problem_stream, solution_template);
+
+	const auto start = std::chrono::steady_clock::now();
+	const Chromosome best = solve(solution_template, time_limit, seed);
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	solution_template.fill_start_times(best);
+	std::ostringstream reply;
+	reply << "SOLVED " << solution_template.total_runtime() << " " << solution_template.absolute_lowest_bound() << " " << seconds << " " << best.size() << "\n";
+	for (size_t task = 0; task < best.size(); ++task)
+	{
+		reply << (task == 0 ? "" : " ") << best[task];
+	}
+	reply << "\n";
+	return reply.str();
+}
+
+/*
+ * Serves the requests of one client until it's gone or sends QUIT.
+ * Returns true on QUIT. `requests` counts the requests over all the clients, the seeds go by it.
+ */
+inline bool serve_client(ServerStream& stream, const ServerSolver& solve, uint64_t seed, uint32_t& requests)
+{
+	std::string line;
+	while (stream.read_line(line))
+	{
+		std::istringstream fields(line);
+		std::string command;
+		fields >> command;
+		if (command.empty())
+		{
+			continue;
+		}
+		if (command == "QUIT")
+		{
+			return true;
+		}
+
+		double time_limit{ 0.0 };
+		size_t length{ 0 };
+		std::string extra;
+		if (command != "SOLVE" || !(fields >> time_limit >> length) || (fields >> extra) || time_limit < 0.0)
+		{
+			// we can't know where the next request starts, the rest of this client's input is lost
+			stream.write("ERROR expected \"SOLVE <time limit> <length>\" or \"QUIT\"\n");
+			return false;
+		}
+		std::string problem;
+		if (!stream.read_bytes(length, problem))
+		{
+			return false;
+		}
+
+		CounterRandom random_engine(seed, 0, requests, RandomStream::Batch);
+		const uint64_t request_seed = (static_cast<uint64_t>(random_engine()) << 32) | random_engine();
+		++requests;
+		std::string reply;
+		try
+		{
+			reply = solve_request(problem, time_limit, solve, request_seed);
+		}
+		catch (const std::exception& error)
+		{
+			reply = std::string("ERROR ") + error.what() + "\n";
+		}
+		std::cerr << "Request " << requests << ": " << reply.substr(0, reply.find('\n')) << "\n";
+		if (!stream.write(reply))
+		{
+			return false;
+		}
+	}
+	return false;
+}
+
+/* serves `address` ("stdin", or a socket address as in Island.h) till QUIT or the end of the stdin */
+inline void run_solver_server(const std::string& address, const ServerSolver& solve, uint64_t seed)
+{
+	// a client which goes away before its reply is an error to handle, not a SIGPIPE killing the server
+	std::signal(SIGPIPE, SIG_IGN);
+	uint32_t requests{ 0 };
+	if (address == "stdin")
+	{
+		std::cerr << "Serving the stdin.\n";
+		ServerStream stream(STDIN_FILENO, STDOUT_FILENO);
+		serve_client(stream, solve, seed, requests);
+		return;
+	}
+
+	Socket listener = listen_on(address);
+	std::cerr << "Serving " << address << ".\n";
+	for (;;)
+	{
+		Socket client(::accept(listener.get(), nullptr, nullptr));
+		if (!client.is_open())
+		{
+			if (errno == EINTR || errno == ECONNABORTED)
+			{
+				continue;
+			}
+			throw std::runtime_error(std::string("accept failed: ") + std::strerror(errno));
+		}
+		ServerStream stream(client.get(), client.get());
+		if (serve_client(stream, solve, seed, requests))
+		{
+			std::cerr << "Stopped by QUIT after " << requests << " requests.\n";
+			return;
+		}
+	}
+}
+
+#else
+
+inline void run_solver_server(const std::string&, const ServerSolver&, uint64_t)
+{
+	throw std::runtime_error("The server needs POSIX descriptors and sockets, it's not available on Windows yet.");
+}
+
+#endif
@@ -0,0 +1,342 @@
+#pragma once
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <barrier>
+
+#include "common.h"
+#include "Random.h"
+#include "IncrementalSchedule.h"
+
+/**
+* Simulated annealing over the order of tasks on machines.
+*
+* This is a cheap single-trajectory alternative to the genetic algorithm:
+* instead of a population of thousands of chromosomes we keep one schedule (and the best one seen so far),
+* and make moves on it, accepting the worse ones with probability exp(-delta / temperature).
+*
+* The move is a swap of two adjacent tasks on a machine.
+* With `critical_move_probability` we pick the pair from the current critical path (these are the only ones which can shorten the makespan),
+* otherwise we pick any pair on any machine to escape the plateaus.
+* Makespan after the move is updated incrementally by `IncrementalSchedule`, no `resolve_conflicts()` involved.
+*/
+
+/* how the temperature goes from the initial to the final one over the run, see `annealing_temperature()` */
+enum class CoolingSchedule
+{
+	Geometric,
+	Linear,
+	LundyMees,
+};
+
+/* the name of the setting, throws if there's no such schedule */
+inline CoolingSchedule parse_cooling_schedule(const std::string& name)
+{
+	if (name == "geometric")
+	{
+		return CoolingSchedule::Geometric;
+	}
+	if (name == "linear")
+	{
+		return CoolingSchedule::Linear;
+	}
+	if (name == "lundy-mees")
+	{
+		return CoolingSchedule::LundyMees;
+	}
+	throw std::runtime_error("cooling_schedule must be \"geometric\", \"linear\" or \"lundy-mees\".");
+}
+
+struct AnnealingSettings
+{
+	double initial_temperature;
+	double final_temperature;
+	long long iterations;
+	CoolingSchedule cooling_schedule;
+	int critical_move_probability; // in percents, same as the mutation probability of the GA
+	MoveEvaluation move_evaluation; // Estimate rejects most of the bad moves without applying them
+	double time_limit; // in seconds, 0 means no limit
+	bool is_quiet; // no progress output, for the runs side by side in the portfolio or the batch
+	ImprovementListener* improvement_listener; // nullptr unless somebody wants every new best schedule as soon as it's found
+};
+
+/*
+ * Temperature for the given fraction of the run done (0 at the start, 1 at the end).
+ * All the schedules start at `initial_temperature` and end at `final_temperature`.
+ */
+inline double annealing_temperature(const AnnealingSettings& settings, double progress)
+{
+	const double t0 = settings.initial_temperature;
+	const double t1 = settings.final_temperature;
+
+	switch (settings.cooling_schedule)
+	{
+	case CoolingSchedule::Linear:
+		return t0 + (t1 - t0) * progress;
+	case CoolingSchedule::LundyMees:
+	{
+		// T = t0 / (1 + beta * k * t0), beta chosen so that we end exactly at t1
+		const double beta = (t0 - t1) / (t0 * t1);
+		return t0 / (1.0 + beta * progress * t0);
+	}
+	case CoolingSchedule::Geometric:
+	default:
+		return t0 * std::pow(t1 / t0, progress);
+	}
+}
+
+/**
+* One annealing "walker": the current schedule and the best one it has seen.
+* Both the plain annealing and the parallel tempering are built out of these.
+*/
+class AnnealingWalker
+{
+private:
+	IncrementalSchedule schedule;
+	Chromosome best_start_times;
+	int best_makespan;
+
+	RandomEngine random_engine;
+	std::vector<std::pair<int, int>> moves; // scratch space for the critical moves
+
+	/* picks a random swap which is guaranteed to not create a cycle, returns false if it couldn't find one */
+	bool pick_move(int critical_move_probability, int& machine_id, int& position)
+	{
+		if (static_cast<int>(random_below(random_engine, 100)) < critical_move_probability)
+		{
+			schedule.critical_moves(moves);
+			if (!moves.empty())
+			{
+				std::tie(machine_id, position) = moves[random_below(random_engine, moves.size())];
+				return true;
+			}
+		}
+
+		machine_id = random_below(random_engine, schedule.machines_count());
+		if (schedule.machine_length(machine_id) < 2)
+		{
+			return false;
+		}
+		position = random_below(random_engine, schedule.machine_length(machine_id) - 1);
+		return schedule.is_swap_safe(machine_id, position);
+	}
+
+public:
+	AnnealingWalker(const SolutionTemplate& solution_template, const Chromosome& start_times, uint64_t seed)
+		: schedule(solution_template, start_times), random_engine(seed)
+	{
+		best_start_times = schedule.get_chromosome();
+		best_makespan = schedule.makespan();
+	}
+
+	/* makes one Metropolis step at the given temperature, returns true if the move was accepted */
+	bool step(double temperature, int critical_move_probability, MoveEvaluation move_evaluation)
+	{
+		int machine_id;
+		int position;
+		if (!pick_move(critical_move_probability, machine_id, position))
+		{
+			return false;
+		}
+
+		const int makespan_before = schedule.makespan();
+		const double threshold = ::random_unit(random_engine);
+		auto is_rejected = [&](int makespan_after) {
+			const int delta = makespan_after - makespan_before;
+			return delta > 0 && threshold >= std::exp(-delta / temperature);
+		};
+
+		// the estimate is cheap and it's a lower bound of the new makespan for the safe moves,
+		// so with it we don't even apply the moves which are going to be rejected anyway
+		if (move_evaluation == MoveEvaluation::Estimate && is_rejected(schedule.evaluate_swap(machine_id, position, MoveEvaluation::Estimate)))
+		{
+			return false;
+		}
+
+		schedule.apply_swap(machine_id, position);
+		if (is_rejected(schedule.makespan()))
+		{
+			schedule.undo();
+			return false;
+		}
+		schedule.commit();
+
+		if (schedule.makespan() < best_makespan)
+		{
+			best_makespan = schedule.makespan();
+			best_start_times = schedule.get_chromosome();
+		}
+		return true;
+	}
+
+	int makespan() const
+	{
+		return schedule.makespan();
+	}
+
+	int get_best_makespan() const
+	{
+		return best_makespan;
+	}
+
+	const Chromosome& get_best_chromosome() const
+	{
+		return best_start_times;
+	}
+
+	double random_unit()
+	{
+		return ::random_unit(random_engine);
+	}
+};
+
+/**
+* Plain simulated annealing, single thread.
+* Returns the best chromosome found (start times, free of conflicts).
+*/
+inline Chromosome solve_using_simulated_annealing(const SolutionTemplate& solution_template, const Chromosome& initial, const AnnealingSettings& settings, uint64_t seed)
+{
+	AnnealingWalker walker(solution_template, initial, seed);
+	const Deadline deadline(settings.time_limit);
+	int published_makespan = std::numeric_limits<int>::max();
+
+	for (long long iteration{ 0 }; iteration < settings.iterations; ++iteration)
+	{
+		// looking at the clock is much more expensive than a step, so only once in a while
+		// the best schedule is published just as often, early on it improves almost every step
+		if (iteration % 1024 == 0 && settings.improvement_listener != nullptr && walker.get_best_makespan() < published_makespan)
+		{
+			published_makespan = walker.get_best_makespan();
+			settings.improvement_listener->improved(walker.get_best_chromosome(), published_makespan);
+		}
+		if (iteration % 1024 == 0 && deadline.is_over())
+		{
+			if (!settings.is_quiet)
+			{
+				std::cout << "Time limit reached at iteration " << iteration << ".\n";
+			}
+			break;
+		}
+
+		const double temperature = annealing_temperature(settings, static_cast<double>(iteration) / settings.iterations);
+		walker.step(temperature, settings.critical_move_probability, settings.move_evaluation);
+
+		if (!settings.is_quiet && iteration % (settings.iterations / 10 + 1) == 0)
+		{
+			std::cout << "iteration " << iteration
+				<< "\ttemperature: " << temperature
+				<< "\tcurrent makespan: " << walker.makespan()
+				<< "\tbest makespan: " << walker.get_best_makespan() << "\n";
+		}
+	}
+
+	if (settings.improvement_listener != nullptr && walker.get_best_makespan() < published_makespan)
+	{
+		settings.improvement_listener->improved(walker.get_best_chromosome(), walker.get_best_makespan());
+	}
+	return walker.get_best_chromosome();
+}
+
+/**
+* Parallel tempering: several walkers at fixed temperatures, each on its own thread.
+* Temperatures are spread geometrically between the initial and the final temperature from the settings.
+* Every `exchange_interval` iterations all the threads meet at the barrier,
+* and the neighbouring temperatures exchange their schedules with the usual replica exchange probability
+* min(1, exp((1/T_i - 1/T_j) * (E_i - E_j))).
+* This way the good schedules found by the hot walkers sink down to the cold ones.
+*/
+inline Chromosome solve_using_parallel_tempering(const SolutionTemplate& solution_template, const Chromosome& initial, const AnnealingSettings& settings, int replicas_count, int exchange_interval, uint64_t seed)
+{
+	std::vector<double> temperatures(replicas_count);
+	for (int i = 0; i < replicas_count; ++i)
+	{
+		const double progress = replicas_count == 1 ? 1.0 : static_cast<double>(i) / (replicas_count - 1);
+		temperatures[i] = settings.initial_temperature * std::pow(settings.final_temperature / settings.initial_temperature, progress);
+	}
+
+	// walker at index i is always at temperature i, exchanges swap the walkers themselves
+	std::vector<AnnealingWalker> walkers;
+	for (int i = 0; i < replicas_count; ++i)
+	{
+		walkers.emplace_back(solution_template, initial, seed + i);
+	}
+
+	const long long rounds = settings.iterations / exchange_interval;
+	long long round{ 0 };
+	int accepted_exchanges{ 0 };
+	const Deadline deadline(settings.time_limit);
+	// set by the exchange, the barrier makes it visible to all the threads, so they all stop after the same round
+	bool is_time_over{ false };
+	int published_makespan = std::numeric_limits<int>::max();
+
+	auto exchange = [&]() noexcept {
+		// runs on one thread while all the others wait at the barrier
+		if (settings.improvement_listener != nullptr)
+		{
+			const auto best = std::min_element(walkers.begin(), walkers.end(), [](const AnnealingWalker& a, const AnnealingWalker& b) {
+				return a.get_best_makespan() < b.get_best_makespan();
+				});
+			if (best->get_best_makespan() < published_makespan)
+			{
+				published_makespan = best->get_best_makespan();
+				settings.improvement_listener->improved(best->get_best_chromosome(), published_makespan);
+			}
+		}
+		for (int i = 0; i + 1 < replicas_count; ++i)
+		{
+			const double energy_difference = walkers[i].makespan() - walkers[i + 1].makespan();
+			const double beta_difference = 1.0 / temperatures[i] - 1.0 / temperatures[i + 1];
+			if (walkers[0].random_unit() < std::exp(std::min(0.0, beta_difference * energy_difference)))
+			{
+				std::swap(walkers[i], walkers[i + 1]);
+				++accepted_exchanges;
+			}
+		}
+
+		if (!settings.is_quiet && round % (rounds / 10 + 1) == 0)
+		{
+			int best_makespan = walkers[0].get_best_makespan();
+			for (const auto& walker : walkers)
+			{
+				best_makespan = std::min(best_makespan, walker.get_best_makespan());
+			}
+			std::cout << "round " << round
+				<< "\tcoldest makespan: " << walkers[replicas_count - 1].makespan()
+				<< "\tbest makespan: " << best_makespan
+				<< "\texchanges accepted: " << accepted_exchanges << "\n";
+		}
+		++round;
+		is_time_over = deadline.is_over();
+	};
+
+	std::barrier sync_point(replicas_count, exchange);
+	std::vector<std::thread> threads;
+	for (int replica = 0; replica < replicas_count; ++replica)
+	{
+		threads.emplace_back([&, replica]() {
+			for (long long r = 0; r < rounds; ++r)
+			{
+				for (int i = 0; i < exchange_interval; ++i)
+				{
+					walkers[replica].step(temperatures[replica], settings.critical_move_probability, settings.move_evaluation);
+				}
+				sync_point.arrive_and_wait();
+				if (is_time_over)
+				{
+					break;
+				}
+			}
+			});
+	}
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	const auto best = std::min_element(walkers.begin(), walkers.end(), [](const AnnealingWalker& a, const AnnealingWalker& b) {
+		return a.get_best_makespan() < b.get_best_makespan();
+		});
+	return best->get_best_chromosome();
+}
@@ -1,6 +1,13 @@
 #pragma once
 
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
 #include "common.h"
+#include "PrecedenceGraph.h"
+#include "TaskScheduler.h"
 
 /**
 * The solution template for the Job Shop problem.
@@ -27,83 +34,168 @@
 class SolutionTemplate
 {
 private:
+	/* description of the tasks as they came from the input, the hot loops use the `graph` instead */
 	std::vector < Task > tasks;
 
 	/*
-	 * for performance, we keep a vector of indices only, no need to copy the values all the time
-	 * For performance reasons as well, sequence of tasks in the machines (in time) may be not the sequence of IDs in these vectors.
-	 * so if you need to show the actual order of tasks on the timeline, you first need to sort this vector by the start time of the tasks.
+	 * The jobs and the machines in the compressed sparse row form, built by `build_graph()` once all the jobs are added.
+	 * Order of tasks in each job is important and it's being kept all the time.
+	 * That is, the sequence of tasks in each job is exactly the sequence of IDs in `graph.job_tasks`.
 	 */
-	std::vector < std::vector < int /* index in tasks */ > > machines;
+	PrecedenceGraph graph;
+
+	/* start times of the tasks, filled from the chromosome */
+	std::vector < int > start_times;
 
 	/*
-	 * same as machines, indices only
-	 * Order of tasks in each job is important and it's being kept all the time.
-	 * That is, the sequence of tasks in each job is exactly the sequence of IDs in these vectors.
+	 * Same layout as `graph.machine_tasks` (ranges by `graph.machine_offsets`), but this one is reordered on every evaluation.
+	 * For performance reasons, sequence of tasks in the machines (in time) may be not the sequence of IDs in this array.
+	 * so if you need to show the actual order of tasks on the timeline, you first need to sort the range by the start time of the tasks.
 	 */
-	std::vector < std::vector < int /* index in tasks */ > > jobs;
+	std::vector < int /* index in tasks */ > machine_order;
+
+	/* scratch space of `compact()`, kept to not allocate for every chromosome */
+	std::vector < int /* index in tasks */ > processing_order;
+	std::vector < int > job_ready_times; // end time of the last placed task of every job
+	std::vector < int > placed_on_machine; // number of the tasks already placed on every machine
 
 	int __cached_horizon{ -1 };
 	int __cached_absolute_lowest_bound{ -1 };
 
+	/*
+	 * Equal start times are ordered by the task index, so the result depends only on the start times
+	 * and not on whatever chromosome was in the template before. Otherwise repairing the same chromosome twice could give different schedules.
+	 */
+	void sort_machine_by_start_times(int machine_id)
+	{
+		std::sort(machine_order.begin() + graph.machine_offsets[machine_id], machine_order.begin() + graph.machine_offsets[machine_id + 1], [&start_times = start_times](int a, int b) {
+			return start_times[a] < start_times[b] || (start_times[a] == start_times[b] && a < b);
+			});
+	}
+
+	/*
+	 * One job of the job-level pass of `resolve_conflicts()`, touches only the tasks of this job.
+	 * Returns false if a task ends after `runtime_bound`.
+	 */
+	bool resolve_job(int job_id, int runtime_bound, bool& had_collision)
+	{
+		const int job_begin = graph.job_offsets[job_id];
+		const int job_end = graph.job_offsets[job_id + 1];
+		for (int i = job_begin; i < job_end - 1; ++i)
+		{
+			const int left_task_index = graph.job_tasks[i];
+			const int right_task_index = graph.job_tasks[i + 1];
+			int start1 = start_times[left_task_index];
+			int length1 = graph.lengths[left_task_index];
+			int start2 = start_times[right_task_index];
+
+			// positive diff means collision (overlap)
+			// zero diff means zero time between the tasks
+			int diff = start1 + length1 - start2;
+			if (diff > 0)
+			{
+				had_collision = true;
+				// move the right task and all after it forward in time by `diff`
+				// note that it can break the sequence of IDs of tasks in the `machine_order` array
+				// that is, the sequence of IDs in the machine ranges will not actually represent the timelines of tasks on these machines
+				for (int j = i + 1; j < job_end; ++j)
+				{
+					start_times[graph.job_tasks[j]] += diff;
+				}
+				const int last_task_index = graph.job_tasks[job_end - 1];
+				if (start_times[last_task_index] + graph.lengths[last_task_index] > runtime_bound)
+				{
+					return false;
+				}
+			}
+		} // end for job steps
+		return true;
+	}
+
+	/* same for one machine of the machine-level pass, touches only the tasks of this machine */
+	bool resolve_machine(int machine_id, int runtime_bound, bool& had_collision)
+	{
+		// sort the ids in the machine by the start time, more accurately representing the timeline after the job-level resolution
+		sort_machine_by_start_times(machine_id);
+
+		const int machine_begin = graph.machine_offsets[machine_id];
+		const int machine_end = graph.machine_offsets[machine_id + 1];
+		for (int i = machine_begin; i < machine_end - 1; ++i)
+		{
+			const int left_task_index = machine_order[i];
+			const int right_task_index = machine_order[i + 1];
+			int start1 = start_times[left_task_index];
+			int length1 = graph.lengths[left_task_index];
+			int start2 = start_times[right_task_index];
+
+			// positive diff means collision (overlap)
+			// zero diff means zero time between the tasks
+			int diff = start1 + length1 - start2;
+			if (diff > 0)
+			{
+				had_collision = true;
+				// move the right task and all after it forward in time by `diff`
+				for (int j = i + 1; j < machine_end; ++j)
+				{
+					start_times[machine_order[j]] += diff;
+				}
+				const int last_task_index = machine_order[machine_end - 1];
+				if (start_times[last_task_index] + graph.lengths[last_task_index] > runtime_bound)
+				{
+					return false;
+				}
+			}
+		} // end for machine steps
+		return true;
+	}
+
 public:
 	/**
 	* This method is used to fill the template with the start times from the chromosome.
 	* Use this method before calculating the fitness.
 	*/
-	void fill_start_times(const Chromosome& start_times)
+	template <typename Gene>
+	void fill_start_times(const BasicChromosome<Gene>& new_start_times)
 	{
-		if (start_times.size() != tasks.size())
+		if (new_start_times.size() != start_times.size())
 		{
 			throw std::runtime_error("Numbers of start times in the chromosome must be the same as number of tasks in the solution template.");
 		}
 
-		for (auto i = 0; i < tasks.size(); ++i)
-		{
-			std::get<4>(tasks[i]) = start_times[i];
-		}
+		std::copy(new_start_times.begin(), new_start_times.end(), start_times.begin());
 
 		// even if we don't run the conflict resolution algorithm, we need to sort the tasks in the machines by the start time
-		for (auto& machine : machines)
+		for (int machine_id = 0; machine_id < graph.machines_count(); ++machine_id)
 		{
-			std::sort(machine.begin(), machine.end(), [&tasks = tasks](int a, int b) {
-				return std::get<4>(tasks[a]) < std::get<4>(tasks[b]);
-				});
+			sort_machine_by_start_times(machine_id);
 		}
 	}
 
 	/**
 	* From the given input, construct one of the jobs of the solution template.
 	* This is used before the genetic algorithm, to setup the proper solution template.
+	* The template can't be used before `build_graph()` is called after the last job.
 	*/
 	void add_job(const int& job_id, const std::vector< std::pair<int /* machine ID */, int /* length */> >& steps)
 	{
-		jobs.resize(job_id + 1);
-		// immediately set to the first element of the new job
-		auto task_index = tasks.size();
-
 		int sequence_number = 0;
 		for (const auto& step : steps)
 		{
 			int machine_id = step.first;
 			int length = step.second;
 
-			// this is the task of `task_index` index
-			tasks.push_back(std::make_tuple(job_id, machine_id, sequence_number, length, 0));
-
-			// register in jobs
-			jobs[job_id].push_back(task_index);
-
-			// register in machines
-			if (machines.size() <= machine_id)
-			{
-				machines.resize(machine_id + 1);
-			}
-			machines[machine_id].push_back(task_index);
-
+			tasks.push_back(std::make_tuple(job_id, machine_id, sequence_number, length));
 			++sequence_number;
-			++task_index;
 		}
+	}
+
+	/* builds the `graph` of all the jobs added so far, the graph is immutable, so it's done once when they are all in */
+	void build_graph()
+	{
+		graph = PrecedenceGraph::build(tasks);
+		start_times.assign(tasks.size(), 0);
+		machine_order = graph.machine_tasks;
+
 		__cached_absolute_lowest_bound = -1;
 		__cached_horizon = -1;
 	}
@@ -114,28 +206,26 @@ public:
 		int task_id{ 0 };
 		for (const auto& task : tasks)
 		{
-			std::cout << task_id << "\t" << " Job: " << std::get<0>(task) << ", Machine: " << std::get<1>(task) << ", Sequence: " << std::get<2>(task) << ", Length: " << std::get<3>(task) << ", Start time: " << std::get<4>(task) << "\n";
+			std::cout << task_id << "\t" << " Job: " << std::get<0>(task) << ", Machine: " << std::get<1>(task) << ", Sequence: " << std::get<2>(task) << ", Length: " << std::get<3>(task) << ", Start time: " << start_times[task_id] << "\n";
 			++task_id;
 		}
 
-		int machine_index = 0;
-		for (const auto& machine : machines)
+		for (int machine_id = 0; machine_id < graph.machines_count(); ++machine_id)
 		{
-			std::cout << "Machine: " << machine_index++ << ": ";
-			for (const auto& task_index : machine)
+			std::cout << "Machine: " << machine_id << ": ";
+			for (int i = graph.machine_offsets[machine_id]; i < graph.machine_offsets[machine_id + 1]; ++i)
 			{
-				std::cout << task_index << " ";
+				std::cout << machine_order[i] << " ";
 			}
 			std::cout << "\n";
 		}
 
-		int job_index = 0;
-		for (const auto& job : jobs)
+		for (int job_id = 0; job_id < graph.jobs_count(); ++job_id)
 		{
-			std::cout << "Job: " << job_index++ << ": ";
-			for (const auto& task_index : job)
+			std::cout << "Job: " << job_id << ": ";
+			for (int i = graph.job_offsets[job_id]; i < graph.job_offsets[job_id + 1]; ++i)
 			{
-				std::cout << task_index << " ";
+				std::cout << graph.job_tasks[i] << " ";
 			}
 			std::cout << "\n";
 		}
@@ -164,8 +254,11 @@ public:
 	 * This is the most brittle part of the process as I can't guarantee that the algorithm will always converge.
 	 * It looks reasonable because we are always "spreading the tasks out" in time, but it's not guaranteed
 	 * as we try to satisfy two constraints at the same time and I am unable to prove it mathematically right now.
+	 *
+	 * Tasks are only ever moved later, so once any task ends after `runtime_bound` the total runtime will too.
+	 * Then we stop right there and return false, the schedule is left half-resolved.
 	 */
-	void resolve_conflicts()
+	bool resolve_conflicts(int runtime_bound = std::numeric_limits<int>::max())
 	{
 		bool had_collision;
 		do
@@ -188,81 +281,161 @@ public:
 			// we need to eliminate them first because if we have sequence breaks we will need to do drastical changes to schedule
 			// (swap of the tasks inside the job) which potentially moves the task very far away on the machine timeline
 			// after that we will need to resolve the conflicts on the machine level
-			for (const auto& steps : jobs)
+			for (int job_id = 0; job_id < graph.jobs_count(); ++job_id)
 			{
-				for (int i = 0; i < steps.size() - 1; ++i)
+				if (!resolve_job(job_id, runtime_bound, had_collision))
 				{
-					const auto& left_task_index = steps[i];
-					const auto& right_task_index = steps[i + 1];
-					const auto& task1 = tasks[left_task_index];
-					const auto& task2 = tasks[right_task_index];
-					int start1 = std::get<4>(task1);
-					int length1 = std::get<3>(task1);
-					int start2 = std::get<4>(task2);
-
-					// positive diff means collision (overlap)
-					// zero diff means zero time between the tasks
-					int diff = start1 + length1 - start2;
-					if (diff > 0)
-					{
-						had_collision = true;
-						// move the right task and all after it forward in time by `diff`
-						// note that it can break the sequence of IDs of tasks in the `machines` vector
-						// that is, the sequence of IDs in the vectors inside `machines` will not actually represent the timelines of tasks on these machines
-						for (int j = i + 1; j < steps.size(); ++j)
-						{
-							auto& task = tasks[steps[j]];
-							std::get<4>(task) += diff;
-						}
-					}
-				} // end for job steps
-			} // end for jobs
+					return false;
+				}
+			}
 
 			// now we need to resolve the machine-level collisions
 			// especially because the job-level collisions resolution could have created new ones.
-			for (auto& machine : machines)
+			for (int machine_id = 0; machine_id < graph.machines_count(); ++machine_id)
 			{
-				// sort the ids in the machine by the start time, more accurately representing the timeline after the job-level resolution
-				std::sort(machine.begin(), machine.end(), [&tasks = tasks](int a, int b) {
-					return std::get<4>(tasks[a]) < std::get<4>(tasks[b]);
-					});
-
-				for (int i = 0; i < machine.size() - 1; ++i)
+				if (!resolve_machine(machine_id, runtime_bound, had_collision))
 				{
-					const auto& left_task_index = machine[i];
-					const auto& right_task_index = machine[i + 1];
-					const auto& task1 = tasks[left_task_index];
-					const auto& task2 = tasks[right_task_index];
-					int start1 = std::get<4>(task1);
-					int length1 = std::get<3>(task1);
-					int start2 = std::get<4>(task2);
-
-					// positive diff means collision (overlap)
-					// zero diff means zero time between the tasks
-					int diff = start1 + length1 - start2;
-					if (diff > 0)
-					{
-						had_collision = true;
-						// move the right task and all after it forward in time by `diff`
-						for (int j = i + 1; j < machine.size(); ++j)
-						{
-							auto& task = tasks[machine[j]];
-							std::get<4>(task) += diff;
-						}
-					}
-				} // end for machine steps
-			} // end for machines
+					return false;
+				}
+			}
 		} while (had_collision);
+		return true;
 	}
 
-	Chromosome get_chromosome() const
+	/**
+	* Same as `resolve_conflicts()` (without the bound), with every pass spread over the threads of the scheduler.
+	*
+	* Within one pass no two jobs (or machines) share a task, so all of them can be resolved at once:
+	* a pass is one parallel loop, and the end of the loop is the barrier before the next pass.
+	* The passes go in the same order, so the result is exactly the one of `resolve_conflicts()`.
+	* It pays off only for the big instances (thousands of tasks), for the small ones the barriers cost more than the passes.
+	*/
+	void resolve_conflicts(TaskScheduler& scheduler)
 	{
-		Chromosome result;
-		for (const auto& task : tasks)
+		// a few chunks per thread, so the uneven jobs and machines can still be balanced by stealing
+		const int job_grain = std::max(1, graph.jobs_count() / (scheduler.threads_count() * 4));
+		const int machine_grain = std::max(1, graph.machines_count() / (scheduler.threads_count() * 4));
+		std::atomic<bool> had_collision;
+		do
+		{
+			had_collision.store(false, std::memory_order_relaxed);
+			scheduler.parallel_for(graph.jobs_count(), job_grain, [&](int begin, int end, int) {
+				bool had_local_collision{ false };
+				for (int job_id = begin; job_id < end; ++job_id)
+				{
+					resolve_job(job_id, std::numeric_limits<int>::max(), had_local_collision);
+				}
+				if (had_local_collision)
+				{
+					had_collision.store(true, std::memory_order_relaxed);
+				}
+				});
+			scheduler.parallel_for(graph.machines_count(), machine_grain, [&](int begin, int end, int) {
+				bool had_local_collision{ false };
+				for (int machine_id = begin; machine_id < end; ++machine_id)
+				{
+					resolve_machine(machine_id, std::numeric_limits<int>::max(), had_local_collision);
+				}
+				if (had_local_collision)
+				{
+					had_collision.store(true, std::memory_order_relaxed);
+				}
+				});
+		} while (had_collision.load(std::memory_order_relaxed));
+	}
+
+	/*
+	 * Global left shift: moves every task to its earliest feasible start time.
+	 * `resolve_conflicts()` only ever pushes tasks later, so the idle gaps from the random start times stay forever.
+	 * This pass removes them.
+	 *
+	 * We rebuild the timeline task by task in the order of the current start times.
+	 * Every task is ready when its predecessor in the job ends, and we put it into the EARLIEST gap on its machine
+	 * which is long enough, even if that gap is before the tasks already placed there.
+	 * So the order of tasks on the machine can change, and the result is an active schedule:
+	 * no task can be started earlier without delaying some other task.
+	 *
+	 * You MUST call this function after the conflicts are resolved!!!
+	 * The order of start times is used as the processing order, so it must respect the sequence of tasks in every job.
+	 *
+	 * A placed task never moves again, so same as in `resolve_conflicts()`, we give up with false
+	 * as soon as one of them ends after `runtime_bound`.
+	 */
+	bool compact(int runtime_bound = std::numeric_limits<int>::max())
+	{
+		const int tasks_count = graph.tasks_count();
+		processing_order.resize(tasks_count);
+		for (int i = 0; i < tasks_count; ++i)
 		{
-			result.push_back(std::get<4>(task));
+			processing_order[i] = i;
 		}
-		return result;
+		// (start time, index) is a strict order, so this is the stable sort by the start time without the buffer `std::stable_sort` allocates
+		std::sort(processing_order.begin(), processing_order.end(), [&start_times = start_times](int a, int b) {
+			return start_times[a] < start_times[b] || (start_times[a] == start_times[b] && a < b);
+			});
+
+		job_ready_times.assign(graph.jobs_count(), 0);
+
+		// machines are rebuilt in the new timeline order, the membership stays the same
+		placed_on_machine.assign(graph.machines_count(), 0);
+
+		for (const auto task_index : processing_order)
+		{
+			const int job_id = graph.job_of_task[task_index];
+			const int machine_id = graph.machine_of_task[task_index];
+			const int length = graph.lengths[task_index];
+			const int machine_begin = graph.machine_offsets[machine_id];
+			const int machine_end = machine_begin + placed_on_machine[machine_id];
+
+			// find the first gap on the machine where the task fits after its job is ready
+			int gap_start = 0;
+			int insert_position = machine_begin;
+			for (; insert_position < machine_end; ++insert_position)
+			{
+				const int next_task_index = machine_order[insert_position];
+				int candidate = std::max(gap_start, job_ready_times[job_id]);
+				if (candidate + length <= start_times[next_task_index])
+				{
+					break;
+				}
+				gap_start = start_times[next_task_index] + graph.lengths[next_task_index];
+			}
+
+			start_times[task_index] = std::max(gap_start, job_ready_times[job_id]);
+			std::copy_backward(machine_order.begin() + insert_position, machine_order.begin() + machine_end, machine_order.begin() + machine_end + 1);
+			machine_order[insert_position] = task_index;
+			++placed_on_machine[machine_id];
+			job_ready_times[job_id] = start_times[task_index] + length;
+			if (job_ready_times[job_id] > runtime_bound)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/*
+	 * Order of tasks on every machine, ranges by `get_graph().machine_offsets`.
+	 * It's the timeline order only after `fill_start_times()`, `resolve_conflicts()` or `compact()`.
+	 */
+	const std::vector<int>& get_machine_order() const
+	{
+		return machine_order;
+	}
+
+	/* read-only access to the structure of the problem, used by the solvers which keep their own schedule representation */
+	const PrecedenceGraph& get_graph() const
+	{
+		return graph;
+	}
+
+	/*
+	 * For the 16-bit genes the caller must know the start times fit, see where the gene type is chosen in main.cpp
+	 */
+	template <typename Gene = int>
+	BasicChromosome<Gene> get_chromosome() const
+	{
+		return BasicChromosome<Gene>(start_times.begin(), start_times.end());
 	}
 
 	int horizon()
@@ -277,9 +450,9 @@ public:
 	int calculate_horizon() const
 	{
 		int result = 0;
-		for (const auto& task : tasks)
+		for (const auto length : graph.lengths)
 		{
-			result += std::get<3>(task);
+			result += length;
 		}
 		return result;
 	}
@@ -296,12 +469,12 @@ public:
 	int calculate_absolute_lowest_bound() const
 	{
 		int max_time{ 0 };
-		for (const auto& machine : machines)
+		for (int machine_id = 0; machine_id < graph.machines_count(); ++machine_id)
 		{
 			int current_time{ 0 };
-			for (const auto& task_index : machine)
+			for (int i = graph.machine_offsets[machine_id]; i < graph.machine_offsets[machine_id + 1]; ++i)
 			{
-				current_time += std::get<3>(tasks[task_index]);
+				current_time += graph.lengths[graph.machine_tasks[i]];
 			}
 			if (current_time > max_time)
 			{
@@ -324,7 +497,13 @@ public:
 		* calculate the total runtime
 		* Determine as a `double` ratio value where in the range (absolute lowest bound, horizon) the total runtime is.
 		*/
-		double total_runtime_value = total_runtime();
+		return fitness_of_runtime(total_runtime());
+	}
+
+	/* same as `fitness()` but for the total runtime calculated elsewhere, e.g. by the batch evaluator */
+	double fitness_of_runtime(int total_runtime) const
+	{
+		double total_runtime_value = total_runtime;
 		double horizon_value = __cached_horizon;
 		double absolute_lowest_bound_value = __cached_absolute_lowest_bound;
 
@@ -342,37 +521,175 @@ public:
 	}
 
 	/*
-	 * You MUST guarantee that the elements in vector `machines` are sorted by the start time of the tasks.
+	 * You MUST guarantee that the machine ranges in `machine_order` are sorted by the start time of the tasks.
 	 */
 	int total_runtime() const
 	{
 		int max_time{ 0 };
-		for (const auto& machine : machines)
+		for (int machine_id = 0; machine_id < graph.machines_count(); ++machine_id)
 		{
-			int last_task_index = machine[machine.size() - 1];
-			int end_time = std::get<4>(tasks[last_task_index]) + std::get<3>(tasks[last_task_index]);
+			int last_task_index = machine_order[graph.machine_offsets[machine_id + 1] - 1];
+			int end_time = start_times[last_task_index] + graph.lengths[last_task_index];
 
 			max_time = std::max(max_time, end_time);
 		}
 		return max_time;
 	}
 
+	/*
+	 * True if the start times are a schedule as they are: nothing starts before 0, a task starts after its job predecessor ends,
+	 * and no two tasks on a machine overlap.
+	 * For the chromosomes which come from outside (the other islands), ours are feasible by construction.
+	 * You MUST guarantee that the machine ranges in `machine_order` are sorted by the start time of the tasks.
+	 */
+	bool is_feasible() const
+	{
+		for (int task_index = 0; task_index < graph.tasks_count(); ++task_index)
+		{
+			if (start_times[task_index] < 0)
+			{
+				return false;
+			}
+			const int predecessor = graph.job_predecessor[task_index];
+			if (predecessor >= 0 && start_times[task_index] < start_times[predecessor] + graph.lengths[predecessor])
+			{
+				return false;
+			}
+		}
+		for (int machine_id = 0; machine_id < graph.machines_count(); ++machine_id)
+		{
+			for (int i = graph.machine_offsets[machine_id] + 1; i < graph.machine_offsets[machine_id + 1]; ++i)
+			{
+				const int previous = machine_order[i - 1];
+				if (start_times[machine_order[i]] < start_times[previous] + graph.lengths[previous])
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
 	void visualize() const
 	{
-		int machine_index{ 0 };
-		for (const auto& machine_task_indices : machines)
+		for (int machine_id = 0; machine_id < graph.machines_count(); ++machine_id)
 		{
-			std::cout << "Machine " << machine_index << ": ";
-			for (const auto task_index : machine_task_indices)
+			std::cout << "Machine " << machine_id << ": ";
+			for (int i = graph.machine_offsets[machine_id]; i < graph.machine_offsets[machine_id + 1]; ++i)
 			{
+				const int task_index = machine_order[i];
 				const auto& task = tasks[task_index];
 				std::cout << "(j" << std::get<0>(task) << "s" << std::get<2>(task) << " "
-					<< std::get<4>(task) << "+" << std::get<3>(task) << ") ";
+					<< start_times[task_index] << "+" << std::get<3>(task) << ") ";
 			}
 			std::cout << "\n";
-			++machine_index;
 		}
 		std::cout << "\n";
 		std::cout << "Total runtime: " << total_runtime() << "\n";
 	}
 };
+
+/**
+* Reads the problem into the empty template: one job per line, pairs of machine ID and task length, the job ID is the number of the line.
+* Blank lines at the end are ignored.
+*
+* Everything after reading assumes that every job and every machine has a task (the last task of a job or of a machine is read without a check),
+* so a problem which breaks that is rejected here, before anything is built from it:
+* the machine IDs must be 0 to N-1 without gaps, no job may be empty, the lengths must be positive,
+* and there must be at least 3 tasks, the crossovers cut the chromosome in up to three parts.
+* Throws with the line and the reason, the server replies with it and the batch records it, so one bad problem doesn't take down the others.
+*/
+inline void read_problem(std::istream& file, SolutionTemplate& solution_template)
+{
+	std::vector<std::vector<std::pair<int /* machine ID */, int /* length */>>> jobs;
+	std::string line;
+	int line_number{ 0 };
+	int blank_line{ 0 }; // the first one since the last job, they are fine at the end only
+	long long tasks_count{ 0 };
+	long long horizon{ 0 };
+	int machines_count{ 0 };
+	while (std::getline(file, line))
+	{
+		++line_number;
+		std::istringstream numbers(line);
+		std::vector<std::pair<int, int>> steps;
+		int machine_id;
+		int task_length;
+		while (numbers >> machine_id)
+		{
+			if (!(numbers >> task_length))
+			{
+				throw std::runtime_error("Line " + std::to_string(line_number) + ": every machine ID must be followed by the length of the task.");
+			}
+			if (machine_id < 0 || task_length <= 0)
+			{
+				throw std::runtime_error("Line " + std::to_string(line_number) + ": machine IDs can't be negative and lengths must be positive.");
+			}
+			steps.push_back({ machine_id, task_length });
+			machines_count = std::max(machines_count, machine_id + 1);
+			horizon += task_length;
+		}
+		if (!numbers.eof())
+		{
+			throw std::runtime_error("Line " + std::to_string(line_number) + ": expected integer pairs of machine ID and length.");
+		}
+		if (steps.empty())
+		{
+			blank_line = blank_line == 0 ? line_number : blank_line;
+			continue;
+		}
+		if (blank_line != 0)
+		{
+			throw std::runtime_error("Line " + std::to_string(blank_line) + ": a job has no tasks.");
+		}
+		tasks_count += steps.size();
+		jobs.push_back(std::move(steps));
+	}
+
+	if (tasks_count < 3)
+	{
+		throw std::runtime_error("The problem must have at least 3 tasks.");
+	}
+	// the start times are ints and a schedule never needs to be longer than all the tasks one after another
+	if (horizon > std::numeric_limits<int>::max() / 2)
+	{
+		throw std::runtime_error("The tasks are too long, their total length must fit into the start times.");
+	}
+	// checked before anything is allocated by the machine, a huge ID can't be without gaps anyway
+	if (machines_count > tasks_count)
+	{
+		throw std::runtime_error("Machine IDs must go from 0 without gaps, there are " + std::to_string(tasks_count) + " tasks and the machine " + std::to_string(machines_count - 1) + ".");
+	}
+	std::vector<char> is_machine_used(machines_count, 0);
+	for (const auto& steps : jobs)
+	{
+		for (const auto& step : steps)
+		{
+			is_machine_used[step.first] = 1;
+		}
+	}
+	const auto unused_machine = std::find(is_machine_used.begin(), is_machine_used.end(), 0);
+	if (unused_machine != is_machine_used.end())
+	{
+		throw std::runtime_error("Machine IDs must go from 0 without gaps, the machine " + std::to_string(unused_machine - is_machine_used.begin()) + " has no tasks.");
+	}
+
+	for (int job_id = 0; job_id < static_cast<int>(jobs.size()); ++job_id)
+	{
+		solution_template.add_job(job_id, jobs[job_id]);
+	}
+	solution_template.build_graph();
+	// cached for the fitness, see `fitness_of_runtime()`
+	solution_template.horizon();
+	solution_template.absolute_lowest_bound();
+}
+
+inline void read_problem(const std::string& filename, SolutionTemplate& solution_template)
+{
+	std::ifstream file(filename);
+	if (!file.is_open())
+	{
+		throw std::runtime_error("Failed to open the file.");
+	}
+	read_problem(file, solution_template);
+}
@@ -0,0 +1,313 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+* Thread pool with work stealing for the parallel loops of the GA.
+*
+* Static chunking of a loop over the population balances badly: a chromosome which needs many passes of
+* `resolve_conflicts()` can cost 10 times as much as a clean one, and the thread which got a few of those
+* finishes long after the others. So the loop is cut into small chunks, every worker gets a contiguous share of them
+* in its own deque, takes them from the back, and when its deque is empty steals from the front of a random other worker.
+* Stealing from the front takes the chunks the owner would reach last, so the owner and the thief rarely meet.
+*
+* The deques are guarded by a mutex each. The owner is the only one taking from the back and the thieves come only
+* when they have nothing else to do, so the locks are hardly ever contended, and a chunk is always big enough
+* (a few chromosomes to repair) for the lock to be noise.
+*
+* The calling thread is worker 0, `threads - 1` more are started once and sleep between the loops.
+* Which worker runs which chunk varies from run to run, so the body must not depend on it
+* other than for picking its per-worker scratch (decoder, evaluator) by the worker number.
+*/
+class TaskScheduler
+{
+private:
+	struct alignas(64) Worker
+	{
+		std::mutex mutex;
+		std::deque<std::pair<int, int>> chunks; // [begin, end) ranges of the current loop
+		uint64_t random_state;
+		long long steals{ 0 };
+		double busy_seconds{ 0.0 };
+	};
+
+	const int threads;
+	std::unique_ptr<Worker[]> workers;
+	std::vector<std::thread> pool;
+
+	// the current loop
+	const std::function<void(int, int, int)>* body{ nullptr };
+	std::atomic<int> remaining_chunks{ 0 };
+	// the first exception of the current loop, the chunks after it are only taken off the deques
+	std::atomic<bool> is_failing{ false };
+	std::exception_ptr loop_error;
+
+	// waking the pool up for a loop and telling the caller it's done
+	std::mutex pool_mutex;
+	std::condition_variable loop_started;
+	std::condition_variable loop_finished;
+	std::atomic<uint64_t> loop_number{ 0 };
+	int busy_workers{ 0 };
+	bool is_stopping{ false };
+
+	long long loops{ 0 };
+	double idle_seconds{ 0.0 };
+
+	// how long a worker polls for the next loop before it goes to sleep
+	static constexpr int SPIN_ROUNDS = 2000;
+
+	/* xorshift, good enough to pick a victim */
+	static int random_below(uint64_t& state, int bound)
+	{
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		return static_cast<int>(state % bound);
+	}
+
+	bool pop_own(int worker_id, std::pair<int, int>& chunk)
+	{
+		Worker& worker = workers[worker_id];
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		if (worker.chunks.empty())
+		{
+			return false;
+		}
+		chunk = worker.chunks.back();
+		worker.chunks.pop_back();
+		return true;
+	}
+
+	bool steal(int worker_id, std::pair<int, int>& chunk)
+	{
+		Worker& thief = workers[worker_id];
+		// start at a random victim and go round, so the thieves don't all queue up on the same deque
+		const int first_victim = random_below(thief.random_state, threads);
+		for (int i = 0; i < threads; ++i)
+		{
+			const int victim_id = (first_victim + i) % threads;
+			if (victim_id == worker_id)
+			{
+				continue;
+			}
+			Worker& victim = workers[victim_id];
+			std::lock_guard<std::mutex> lock(victim.mutex);
+			if (!victim.chunks.empty())
+			{
+				chunk = victim.chunks.front();
+				victim.chunks.pop_front();
+				++thief.steals;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/* runs the chunks of the current loop until there are none left anywhere */
+	void work(int worker_id)
+	{
+		Worker& worker = workers[worker_id];
+		std::pair<int, int> chunk;
+		while (remaining_chunks.load(std::memory_order_acquire) > 0)
+		{
+			if (!pop_own(worker_id, chunk) && !steal(worker_id, chunk))
+			{
+				// the rest is being run by the others, nothing to take
+				std::this_thread::yield();
+				continue;
+			}
+			if (!is_failing.load(std::memory_order_acquire))
+			{
+				const auto start = std::chrono::steady_clock::now();
+				try
+				{
+					(*body)(chunk.first, chunk.second, worker_id);
+				}
+				catch (...)
+				{
+					// the caller rethrows it once every worker is out of the loop, the others still use `body` till then
+					std::lock_guard<std::mutex> lock(pool_mutex);
+					if (!loop_error)
+					{
+						loop_error = std::current_exception();
+					}
+					is_failing.store(true, std::memory_order_release);
+				}
+				worker.busy_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			}
+			remaining_chunks.fetch_sub(1, std::memory_order_acq_rel);
+		}
+	}
+
+	void run_pool_worker(int worker_id)
+	{
+		uint64_t seen_loop{ 0 };
+		for (;;)
+		{
+			// the loops of one repair come every few microseconds, waking up from the condition variable takes longer than that
+			for (int spin = 0; spin < SPIN_ROUNDS && loop_number.load(std::memory_order_acquire) == seen_loop; ++spin)
+			{
+				std::this_thread::yield();
+			}
+			{
+				std::unique_lock<std::mutex> lock(pool_mutex);
+				loop_started.wait(lock, [&]() { return is_stopping || loop_number != seen_loop; });
+				if (is_stopping)
+				{
+					return;
+				}
+				seen_loop = loop_number;
+			}
+
+			work(worker_id);
+
+			std::lock_guard<std::mutex> lock(pool_mutex);
+			if (--busy_workers == 0)
+			{
+				loop_finished.notify_one();
+			}
+		}
+	}
+
+public:
+	explicit TaskScheduler(int threads) : threads(std::max(threads, 1)), workers(new Worker[std::max(threads, 1)])
+	{
+		for (int i = 0; i < this->threads; ++i)
+		{
+			workers[i].random_state = 0x9E3779B97F4A7C15ull * (i + 1);
+		}
+		for (int i = 1; i < this->threads; ++i)
+		{
+			pool.emplace_back(&TaskScheduler::run_pool_worker, this, i);
+		}
+	}
+
+	TaskScheduler(const TaskScheduler&) = delete;
+	TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+	~TaskScheduler()
+	{
+		{
+			std::lock_guard<std::mutex> lock(pool_mutex);
+			is_stopping = true;
+		}
+		loop_started.notify_all();
+		for (auto& thread : pool)
+		{
+			thread.join();
+		}
+	}
+
+	int threads_count() const
+	{
+		return threads;
+	}
+
+	/**
+	* Calls `loop_body(begin, end, worker_id)` for chunks of at most `grain` indices covering [0, count),
+	* returns when all of them are done. `worker_id` is in [0, threads_count()).
+	* If the body throws, the chunks not started yet are skipped and the first exception is rethrown here
+	* after all the workers are done with the loop, so the scheduler can be used again.
+	*/
+	template <typename Body>
+	void parallel_for(int count, int grain, Body&& loop_body)
+	{
+		if (count <= 0)
+		{
+			return;
+		}
+		const std::function<void(int, int, int)> function(std::forward<Body>(loop_body));
+		const int chunks_count = (count + grain - 1) / grain;
+
+		// contiguous shares, so with even costs nobody has to steal at all
+		for (int chunk = 0; chunk < chunks_count; ++chunk)
+		{
+			Worker& worker = workers[static_cast<long long>(chunk) * threads / chunks_count];
+			std::lock_guard<std::mutex> lock(worker.mutex);
+			worker.chunks.push_front({ chunk * grain, std::min(count, (chunk + 1) * grain) });
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		double busy_before{ 0.0 };
+		for (int i = 0; i < threads; ++i)
+		{
+			busy_before += workers[i].busy_seconds;
+		}
+
+		body = &function;
+		remaining_chunks.store(chunks_count, std::memory_order_release);
+		{
+			std::lock_guard<std::mutex> lock(pool_mutex);
+			busy_workers = threads - 1;
+			++loop_number;
+		}
+		loop_started.notify_all();
+
+		work(0);
+
+		{
+			std::unique_lock<std::mutex> lock(pool_mutex);
+			loop_finished.wait(lock, [&]() { return busy_workers == 0; });
+		}
+		body = nullptr;
+		if (is_failing.load(std::memory_order_acquire))
+		{
+			std::exception_ptr error = std::exchange(loop_error, nullptr);
+			is_failing.store(false, std::memory_order_release);
+			std::rethrow_exception(error);
+		}
+
+		// everything the workers didn't spend in the chunks is idle: waiting to steal or for the last chunk to finish
+		double busy_after{ 0.0 };
+		for (int i = 0; i < threads; ++i)
+		{
+			busy_after += workers[i].busy_seconds;
+		}
+		const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		idle_seconds += std::max(0.0, elapsed * threads - (busy_after - busy_before));
+		++loops;
+	}
+
+	long long steals_count() const
+	{
+		long long result{ 0 };
+		for (int i = 0; i < threads; ++i)
+		{
+			result += workers[i].steals;
+		}
+		return result;
+	}
+
+	/* summed over the workers */
+	double idle_time() const
+	{
+		return idle_seconds;
+	}
+
+	double busy_time() const
+	{
+		double result{ 0.0 };
+		for (int i = 0; i < threads; ++i)
+		{
+			result += workers[i].busy_seconds;
+		}
+		return result;
+	}
+
+	long long loops_count() const
+	{
+		return loops;
+	}
+};
@@ -1,4 +1,5 @@
 #pragma once
+#include <chrono>
 #include <tuple>
 #include <limits>
 #include <vector>
@@ -8,14 +9,58 @@ typedef std::tuple<
 	const int /* 0 job ID */,
 	const int /* 1 machine ID */,
 	const int /* 2 sequence number */,
-	const int /* 3 length */,
-	int       /* 4 start time NOT const */
-> Task;
+	const int /* 3 length */
+> Task; // start times live in the solution template, next to the other arrays used by the decoder
 
-typedef std::vector<int /* task start time */> Chromosome;
+/*
+ * Gene is the start time of a task. The GA can store them in 16 bits when the horizon of the problem allows it,
+ * which halves the memory traffic over the population. Everything outside of the GA uses the 32-bit `Chromosome`.
+ */
+template <typename Gene>
+using BasicChromosome = std::vector<Gene /* task start time */>;
+
+typedef BasicChromosome<int> Chromosome;
 
 typedef double Fitness;
 
-typedef std::tuple<Chromosome, Fitness, int /* generation */> Specimen;
+template <typename Gene>
+using BasicSpecimen = std::tuple<BasicChromosome<Gene>, Fitness, int /* generation */>;
+
+template <typename Gene>
+using BasicPopulation = std::vector<BasicSpecimen<Gene>>;
+
+typedef BasicSpecimen<int> Specimen;
+
+typedef BasicPopulation<int> Population;
+
+/*
+ * Told about every new best schedule of a solver as soon as it's found, see Improvements.h.
+ * It's called from the threads of the solver, in the middle of the search, so it must be quick and safe to call from several threads at once.
+ */
+class ImprovementListener
+{
+public:
+	virtual ~ImprovementListener() = default;
+
+	virtual void improved(const Chromosome& best, int total_runtime) = 0;
+};
+
+/* wall clock limit of a solver, started at construction, 0 seconds means no limit */
+class Deadline
+{
+private:
+	std::chrono::steady_clock::time_point end;
+	bool is_limited;
+
+public:
+	explicit Deadline(double seconds)
+		: end(std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds))),
+		is_limited(seconds > 0.0)
+	{
+	}
 
-typedef std::vector<Specimen> Population;
\ No newline at end of file
+	bool is_over() const
+	{
+		return is_limited && std::chrono::steady_clock::now() >= end;
+	}
+};
\ No newline at end of file
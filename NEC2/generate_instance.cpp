@@ -0,0 +1,67 @@
+/*
+ * Generates the header with the compile-time tables of one problem for the fixed decoder (see FixedSolutionTemplate.h).
+ *
+ * Usage: generate_instance la40seti5.txt > FixedInstance.generated.h
+ *
+ * The problem file is read and checked by the same `read_problem()` as main.cpp uses.
+ */
+
+#include <iostream>
+#include <string>
+
+#include "common.h"
+#include "SolutionTemplate.h"
+
+static void print_array(const char* name, const std::vector<int>& values)
+{
+	std::cout << "\t." << name << " = { ";
+	for (size_t i = 0; i < values.size(); ++i)
+	{
+		std::cout << (i == 0 ? "" : ", ") << values[i];
+	}
+	std::cout << " },\n";
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc != 2)
+	{
+		std::cerr << "Usage: " << argv[0] << " problem_file > FixedInstance.generated.h\n";
+		return 1;
+	}
+
+	SolutionTemplate solution_template;
+	try
+	{
+		read_problem(argv[1], solution_template);
+	}
+	catch (const std::exception& error)
+	{
+		std::cerr << error.what() << std::endl;
+		return 1;
+	}
+
+	const PrecedenceGraph& graph = solution_template.get_graph();
+	const std::string sizes = std::to_string(graph.jobs_count()) + ", " + std::to_string(graph.machines_count()) + ", " + std::to_string(graph.tasks_count());
+
+	std::cout << "#pragma once\n"
+		<< "\n"
+		<< "// generated by generate_instance from " << argv[1] << ", don't edit\n"
+		<< "\n"
+		<< "#include \"FixedSolutionTemplate.h\"\n"
+		<< "\n"
+		<< "inline constexpr FixedInstance<" << sizes << "> fixed_instance{\n";
+	print_array("lengths", graph.lengths);
+	print_array("job_of_task", graph.job_of_task);
+	print_array("machine_of_task", graph.machine_of_task);
+	print_array("job_successor", graph.job_successor);
+	print_array("job_offsets", graph.job_offsets);
+	print_array("job_tasks", graph.job_tasks);
+	print_array("machine_offsets", graph.machine_offsets);
+	print_array("machine_tasks", graph.machine_tasks);
+	std::cout << "};\n"
+		<< "\n"
+		<< "typedef FixedDecoder<" << sizes << ", fixed_instance> FixedInstanceDecoder;\n";
+
+	return 0;
+}
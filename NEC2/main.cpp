@@ -92,359 +92,214 @@ Mutations will _shorten_ the time gaps not _lengthen_ them.
 #include <fstream>
 #include <utility>
 #include <sstream>
+#include <string>
 
 #include <random>
 
 #include "common.h"
+#include "Random.h"
+#include "Kernels.h"
+#include "Configuration.h"
 #include "SolutionTemplate.h"
+#include "GeneticAlgorithm.h"
+#include "SimulatedAnnealing.h"
+#include "Island.h"
+#include "Portfolio.h"
+#include "Batch.h"
+#include "Server.h"
+#include "Improvements.h"
 
 std::random_device rd;
 
-/* ------------ SETTINGS BEGIN ------- */
-
-std::mt19937 random_engine(rd());
-
-constexpr auto problem_filename = "la40seti5.txt";
-constexpr auto crossover_type = "2-point"; // "1-point" or "2-point"
-constexpr auto is_selection_tainted = true; // whether we put the worst specimen back into the population
-constexpr auto mutation_type = "uniform XOR"; // "singular" or "uniform XOR"
-
-
-// set the number of chromosomes in the population
-constexpr auto population_size = 10000;
-constexpr auto index_of_middle_specimen = population_size / 2 - 1;
-constexpr auto index_of_last_specimen = population_size - 1;
-
-// set the number of generations
-constexpr auto generations = 500;
-
-// set the probability of mutation
-constexpr auto mutation_probability = 10;
-constexpr auto MIN_MUTATION_VALUE = -2;
-constexpr auto MAX_MUTATION_VALUE = 2;
-
-/* ------------ SETTINGS END ------- */
-
-// for percents let's use actual percent values instead of doubles, it's easier to work with integers
-static std::uniform_int_distribution<> random_percent_distribution(0, 100);
-
+// all the settings of the run, with their defaults, are in Configuration.h
+// they can be changed from the command line or a config file, see `./main --help`
+static Configuration configuration;
 
 // the solution template is a global variable as we never create more than one instance of it
 static SolutionTemplate solution_template;
 
 /*
-* 2-point crossover between two vectors.
-* Min size of both vectors is 3.
-* We never swap the first element.
-*/
-std::pair<Chromosome, Chromosome> crossover_2point(const Chromosome& left, const Chromosome& right)
+ * Local search solvers return only the chromosome, so we report it in the same way as the GA does.
+ */
+void report_solution(const Chromosome& best)
 {
-    if (left.size() != right.size())
-    {
-        throw std::runtime_error("Chromosomes must be of the same length.");
-    }
-	if (left.size() < 3)
-	{
-		throw std::runtime_error("Chromosomes must have at least 3 elements.");
-	}
-
-	// sneaky sneaky static + globals
-    static std::uniform_int_distribution<> dist(1, left.size() - 2);
-	int point1 = dist(random_engine);
-    int point2 = dist(random_engine);
+	solution_template.fill_start_times(best);
+	std::cout << "Best solution found:\n";
+	solution_template.print();
+	solution_template.visualize();
+	std::cout << "Fitness: " << solution_template.fitness() << "\n";
+}
 
-    if (point1 > point2)
-    {
-        std::swap(point1, point2);
-    }
-	if (point1 == point2)
+/*
+ * Writes the schedule for the other tools: the total runtime, then one task per line.
+ */
+void write_solution(const Chromosome& best, const std::string& filename)
+{
+	std::ofstream file(filename);
+	if (!file.is_open())
 	{
-        point2++;
+		std::cerr << "Failed to open the solution file " << filename << ".\n";
+		return;
 	}
 
-
-	Chromosome offspring1{ left };
-	Chromosome offspring2{ right };
-
-	// swap_ranges doesn't compile in VS 2022
-	//auto left_start_position = left.begin() + point1;
-	//auto left_end_position = left.begin() + point2;
-	//auto right_start_position = right.begin() + point1;
-	//std::swap_ranges(left_start_position, left_end_position, right_start_position); 
-	// so we use a loop with standard swap instead
-	for (auto i = 0; i < point2 - point1; ++i)
+	const PrecedenceGraph& graph = solution_template.get_graph();
+	solution_template.fill_start_times(best);
+	file << "# total runtime: " << solution_template.total_runtime() << "\n";
+	file << "# task job machine start length\n";
+	for (int task_index = 0; task_index < graph.tasks_count(); ++task_index)
 	{
-		std::swap(offspring1[point1 + i], offspring2[point1 + i]);
+		file << task_index << " " << graph.job_of_task[task_index] << " " << graph.machine_of_task[task_index] << " "
+			<< best[task_index] << " " << graph.lengths[task_index] << "\n";
 	}
+	std::cout << "Solution written to " << filename << "\n";
+}
 
-	solution_template.fill_start_times(offspring1);
-	solution_template.resolve_conflicts();
-	offspring1 = solution_template.get_chromosome();
+/* settings of the annealing from the configuration */
+AnnealingSettings make_annealing_settings()
+{
+	return AnnealingSettings{
+		.initial_temperature = configuration.initial_temperature,
+		.final_temperature = configuration.final_temperature,
+		.iterations = configuration.iterations,
+		.cooling_schedule = parse_cooling_schedule(configuration.cooling_schedule),
+		.critical_move_probability = configuration.critical_move_probability,
+		.move_evaluation = configuration.move_evaluation == "exact" ? MoveEvaluation::Exact : MoveEvaluation::Estimate,
+		.time_limit = configuration.time_limit,
+		.is_quiet = false,
+		.improvement_listener = nullptr, // main sets the publisher of the improvements
+	};
+}
 
-	solution_template.fill_start_times(offspring2);
-	solution_template.resolve_conflicts();
-	offspring2 = solution_template.get_chromosome();
+/* numeric settings of the GA from the configuration */
+GeneticSettings make_genetic_settings()
+{
+	return GeneticSettings{
+		.mode = configuration.genetic_mode == "steady-state" ? GeneticMode::SteadyState
+			: configuration.genetic_mode == "asynchronous" ? GeneticMode::Asynchronous
+			: configuration.genetic_mode == "pipelined" ? GeneticMode::Pipelined : GeneticMode::Generational,
+		.population_size = configuration.population_size,
+		.generations = configuration.generations,
+		.mutation_probability = configuration.mutation_probability,
+		.min_mutation_value = configuration.min_mutation_value,
+		.max_mutation_value = configuration.max_mutation_value,
+		.is_duplicate_elimination_enabled = configuration.is_duplicate_elimination_enabled,
+		.heavy_mutation_value = configuration.heavy_mutation_value,
+		.diversity_sample_size = configuration.diversity_sample_size,
+		.fitness_cache_capacity = configuration.fitness_cache_capacity,
+		.time_limit = configuration.time_limit,
+		.threads = configuration.thread_count(),
+		.tournament_size = configuration.tournament_size,
+		.evaluations = configuration.evaluations,
+		.migration_link = nullptr, // the islands set their own
+		.migration_interval = configuration.migration_interval,
+		.migrants_count = configuration.migrants,
+		.is_quiet = false,
+		.scheduler = nullptr, // the server sets its pool
+		.improvement_listener = nullptr, // main sets the publisher of the improvements
+	};
+}
 
-    return std::make_pair(offspring1, offspring2);
+/* the seed of the run, printed so the run can be repeated */
+uint64_t make_seed(std::ostream& log)
+{
+	const uint64_t seed = configuration.random_seed != 0 ? configuration.random_seed : (static_cast<uint64_t>(rd()) << 32) | rd();
+	log << "Seed: " << seed << "\n";
+	return seed;
 }
 
 /*
-* 1-point crossover between two vectors.
-* Min size of both vectors is 3.
-*/
-std::pair<Chromosome, Chromosome> crossover_1point(const Chromosome& left, const Chromosome& right)
+ * Solves one of many problems (of the batch or the server) with the solver of the configuration, without any output.
+ * `genetic_solver` is the GA of the configuration, nullptr for the annealing. `scheduler` is the pool for the GA, nullptr means its own.
+ */
+Chromosome solve_quietly(SolutionTemplate& instance_template, const GeneticSolver* genetic_solver, double time_limit, int threads, TaskScheduler* scheduler, uint64_t seed)
 {
-	if (left.size() != right.size())
-	{
-		throw std::runtime_error("Chromosomes must be of the same length.");
-	}
-	if (left.size() < 3)
-	{
-		throw std::runtime_error("Chromosomes must have at least 3 elements.");
-	}
-
-	// sneaky sneaky static + globals
-	static std::uniform_int_distribution<> dist(1, left.size() - 2);
-	int crossover_point = dist(random_engine);
-
-	Chromosome offspring1{ left };
-	Chromosome offspring2{ right };
-
-	for (auto i = 0; i < crossover_point; ++i)
+	if (genetic_solver != nullptr)
 	{
-		std::swap(offspring1[i], offspring2[i]);
+		GeneticSettings settings = make_genetic_settings();
+		settings.threads = threads;
+		settings.time_limit = time_limit;
+		settings.is_quiet = true;
+		settings.scheduler = scheduler;
+		return genetic_solver->solve(instance_template, settings, seed);
 	}
 
-	solution_template.fill_start_times(offspring1);
-	solution_template.resolve_conflicts();
-	offspring1 = solution_template.get_chromosome();
-
-	solution_template.fill_start_times(offspring2);
-	solution_template.resolve_conflicts();
-	offspring2 = solution_template.get_chromosome();
-
-	return std::make_pair(offspring1, offspring2);
-}
-/**
-* Returns the NEW chromosome with one of the start times mutated.
-* There's randomness both in the position of the mutation and the value of the mutation.
-*/
-Chromosome mutate_singular(const Chromosome& input)
-{
-	// sneaky sneaky static + globals
-	static std::uniform_int_distribution<> positions_distribution(0, input.size() - 1);
-	auto position = positions_distribution(random_engine);
-
-	static std::uniform_int_distribution<int> mutation_value_distribution(MIN_MUTATION_VALUE, MAX_MUTATION_VALUE);
-	auto mutation_value = mutation_value_distribution(random_engine);
-
-	Chromosome result{ input };
-	result[position] += mutation_value;
-
-	// if mutation goes below 0, we need to correct it
-	if (result[position] < 0)
+	AnnealingSettings settings = make_annealing_settings();
+	settings.time_limit = time_limit;
+	settings.is_quiet = true;
+	CounterRandom random_engine(seed, 0, 0, RandomStream::Initialisation);
+	CompactingDecoder decoder(instance_template);
+	const Chromosome initial = make_chromosome<int>(random_engine, decoder);
+	if (configuration.solver_type == "annealing")
 	{
-		// we replace the mutation value with the absolute value of the mutation
-		result[position] -= mutation_value * 2;
+		return solve_using_simulated_annealing(instance_template, initial, settings, seed);
 	}
-
-	solution_template.fill_start_times(result);
-	solution_template.resolve_conflicts();
-
-	return solution_template.get_chromosome();
+	return solve_using_parallel_tempering(instance_template, initial, settings, configuration.tempering_replicas, configuration.tempering_exchange_interval, seed);
 }
 
-/**
-* Returns the NEW chromosome with one of the start times mutated.
-* This variant of mutation does XOR 1 to every element of the chromosome.
-* This introduces a lot of randomness and is not guaranteed to be feasible.
-*/
-Chromosome mutate_xor(const Chromosome& input)
+/* the GA of the configuration for the batch and the server, nullptr for the annealing, throws before any work if it doesn't exist */
+const GeneticSolver* find_quiet_genetic_solver()
 {
-
-	Chromosome result{ input };
-	for (auto& value : result)
-	{
-		value ^= 1;
-	}
-
-	solution_template.fill_start_times(result);
-	solution_template.resolve_conflicts();
-
-	return solution_template.get_chromosome();
+	return configuration.solver_type == "genetic"
+		? &find_genetic_solver(configuration.crossover_type, configuration.selection_type, configuration.mutation_type, configuration.decoder_type)
+		: nullptr;
 }
 
 /*
- * make a chromosome
- *
- * MUST be called after the solution_template is set up!!!
- * 
- * we cannot just make a random array of ints
- * every int is a starting time of the task
- * we need to apply the same conflict resolution algorithm to the chromosome
- * also we need to allow chromosomes where starting time of non-conflicting tasks may overlap,
- * because it's allowed and it's a whole point of parallelism through machines.
-*/
-Chromosome make_chromosome()
+ * Solves all the instances of `configuration.batch` with the solver of the configuration, quietly, see Batch.h.
+ * Returns the exit code: 0 if all of them were solved.
+ */
+int run_batch()
 {
-	// get the chromosome of the correct length
-	Chromosome raw = solution_template.get_chromosome();
-
-	// 1. fill the chromosome with random numbers between 0 and an absolute lowest bound
-	// Initial design was using half of horizon but with a lot of tasks (around 150) the difference between the lowest bound and the horizon is very large (x10 large)
-	// and the conflict resolution always "spreads" the tasks in time, so it's better to start with the lesser value
-	static std::uniform_int_distribution<> start_time_distribution(0, solution_template.absolute_lowest_bound());
-	for (auto& start_time : raw)
-	{
-		// start_time is a reference, so we can modify it directly
-		start_time = start_time_distribution(random_engine);
-	}
-
-	// 2. put the randomized chromosome back into the solution template and resolve conflicts
-	solution_template.fill_start_times(raw);
-	solution_template.resolve_conflicts();
-
-	// 3. get the clean chromosome back
-	return solution_template.get_chromosome();
+	const uint64_t seed = make_seed(std::cout);
+	std::cout << "Threads: " << configuration.thread_count() << "\n";
+
+	const GeneticSolver* genetic_solver = find_quiet_genetic_solver();
+	const BatchSolver solve = [genetic_solver](SolutionTemplate& instance_template, const BatchInstance& instance, int threads, uint64_t instance_seed) {
+		return solve_quietly(instance_template, genetic_solver, instance.time_limit, threads, nullptr, instance_seed);
+	};
+
+	const BatchSettings settings{
+		.path = configuration.batch,
+		.results_filename = configuration.batch_results,
+		.time_limit = configuration.time_limit,
+		.threads = configuration.thread_count(),
+		.instance_threads = configuration.batch_instance_threads,
+	};
+	return solve_batch(settings, solve, seed) == 0 ? 0 : 1;
 }
 
-Specimen solve_using_genetic_algorithm()
+/*
+ * Serves the requests at `configuration.serve` till QUIT, see Server.h.
+ * One pool of threads runs the GA of all the requests.
+ */
+int run_server()
 {
-	Population population;
-
-	// generate the initial population
-	for (int i = 0; i < population_size; ++i)
-	{
-		population.push_back({ make_chromosome(), 0, 0 });
-	}
-
-	for (int generation{ 0 }; generation < generations; ++generation)
-	{
-		for (auto& specimen : population)
-		{
-			// calculate the fitness of each chromosome of this generation
-			if (std::get<2>(specimen) == generation)
-			{
-				solution_template.fill_start_times(std::get<0>(specimen));
-				// don't need to resolve conflicts as all our operators do it
-				std::get<1>(specimen) = solution_template.fitness();
-			}
-		}
-		// sort the population by fitness descending
-		std::sort(population.begin(), population.end(), [](const Specimen& a, const Specimen& b) {
-			return std::get<1>(a) > std::get<1>(b);
-			});
-
-		std::cout << std::fixed << std::setprecision(2);
-		if (generation % 50 == 0)
-		{
-			std::cout << "generation " << generation
-				<< "\tbest fitnesses: "
-				<< std::get<1>(population[0]) << ", "
-				<< std::get<1>(population[1]) << ", "
-				<< std::get<1>(population[2])
-				<< "\tworst fitnesses: "
-				<< std::get<1>(population[population_size - 2]) << ", "
-				<< std::get<1>(population[population_size - 1]) << "\n";
-		}
-
-		if (generation == generations - 1)
-		{
-			// on the last generation we don't need to breed, just stop
-			std::cout << "Last generation reached.\n";
-			break;
-		}
-
-		if (is_selection_tainted)
-		{
-			// put the worst chromosome into the half of the population allowed to breed
-			std::swap(population[index_of_middle_specimen], population[index_of_last_specimen]);
-		}
-
-		// for each pair of specimens in the first half of the population
-		for (size_t i = 0; i < population_size / 2; i += 2)
-		{
-			// obtain their chromosomes
-			const auto& parent1 = std::get<0>(population[i]);
-			const auto& parent2 = std::get<0>(population[i + 1]);
-
-			// crossover the chosen chromosomes obtaining the new pair
-			Chromosome offspring1;
-			Chromosome offspring2;
-			if (crossover_type == "1-point")
-			{
-				std::tie(offspring1, offspring2) = crossover_1point(parent1, parent2);
-			}
-			else if (crossover_type == "2-point")
-			{
-				std::tie(offspring1, offspring2) = crossover_2point(parent1, parent2);
-			}
-			else
-			{
-				throw std::runtime_error("Unknown crossover type.");
-			}
-
-			// construct two new specimens with the new pair and the generation number
-			Specimen new_specimen1{ offspring1, 0, generation + 1 };
-			Specimen new_specimen2{ offspring2, 0, generation + 1 };
-
-			// put the new pair into the second half of the population
-			population[population_size / 2 + i] = new_specimen1;
-			population[population_size / 2 + i + 1] = new_specimen2;
-		}
-
-		// mutate the whole population
-		for (auto& specimen : population)
-		{
-			bool should_mutate = random_percent_distribution(random_engine) < mutation_probability;
-			if (should_mutate)
-			{
-				if (mutation_type == "singular")
-				{
-					std::get<0>(specimen) = mutate_singular(std::get<0>(specimen));
-				}
-				else if (mutation_type == "uniform XOR")
-				{
-					std::get<0>(specimen) = mutate_xor(std::get<0>(specimen));
-				}
-				else
-				{
-					throw std::runtime_error("Unknown mutation type.");
-				}
-
-				if (std::get<2>(specimen) == generation)
-				{
-					// if we mutated the chromosome in the current generation,
-					// we need to recalculate the fitness as we calculate the fitness only once per new generation
-					solution_template.fill_start_times(std::get<0>(specimen));
-					std::get<1>(specimen) = solution_template.fitness();
-				}
-			}
-		}
-	}
-
-	solution_template.fill_start_times(std::get<0>(population[0]));
-	std::cout << "Best solution found:\n";
-	solution_template.print();
-	solution_template.visualize();
-	std::cout << "Fitness: " << std::get<1>(population[0]) << "\n";
-	std::cout << "Generation: " << std::get<2>(population[0]) << "\n";
-
-	return population[0];
+	// with the stdin the stdout is for the replies only
+	const uint64_t seed = make_seed(std::cerr);
+	std::cerr << "Threads: " << configuration.thread_count() << "\n";
+	const GeneticSolver* genetic_solver = find_quiet_genetic_solver();
+	TaskScheduler scheduler(configuration.thread_count());
+	const ServerSolver solve = [&](SolutionTemplate& instance_template, double time_limit, uint64_t request_seed) {
+		return solve_quietly(instance_template, genetic_solver, time_limit, configuration.thread_count(), &scheduler, request_seed);
+	};
+	run_solver_server(configuration.serve, solve, seed);
+	return 0;
 }
 
 /* debug function to test the conflict resolution */
 void single_test()
 {
-	Chromosome left = make_chromosome();
-	Chromosome right = make_chromosome();
+	CounterRandom random_engine(rd(), 0, 0, RandomStream::Initialisation);
+	PushLaterDecoder decoder(solution_template);
+	Chromosome left = make_chromosome<int>(random_engine, decoder);
+	Chromosome right = make_chromosome<int>(random_engine, decoder);
 	solution_template.fill_start_times(left);
 	std::cout << "Left chromosome:\n";
 	solution_template.visualize();
 	solution_template.fill_start_times(right);
 	std::cout << "Right chromosome:\n";
 	solution_template.visualize();
-	auto [offspring1, offspring2] = crossover_2point(left, right);
+	auto [offspring1, offspring2] = TwoPointCrossover::apply(left, right, random_engine);
 
 	std::cout << "Offspring 1:\n";
 	solution_template.fill_start_times(offspring1);
@@ -473,58 +328,186 @@ void exact_test()
 	std::cout << "Fitness: " << solution_template.fitness() << "\n";
 }
 
-int main()
+int main(int argc, char* argv[])
 {
-    std::ifstream file(problem_filename);
-    if (!file.is_open())
-    {
-        std::cerr << "Failed to open the file." << std::endl;
-        return 1;
-    }
-
-	int horizon{ 0 };
-	int chromosome_length{ 0 };
-
-    std::vector<std::pair<int, int>> input_data_line;
-    std::string input_text_line;
-	int machine_id;
-	int task_length;
-	int job_id{ 0 };
-	while (std::getline(file, input_text_line))
-    {
-		input_data_line.clear();
-        std::istringstream iss(input_text_line);
-        while (iss >> machine_id >> task_length)
-        {
-            input_data_line.push_back(std::make_pair(machine_id, task_length));
-			horizon += task_length;
-			++chromosome_length;
-        }
-
-		// Output the pairs to verify
-		for (const auto& p : input_data_line)
+	try
+	{
+		const ConfigurationParser parser;
+		if (!parser.parse_command_line(configuration, argc, argv))
 		{
-			std::cout << "(" << p.first << ", " << p.second << ") ";
+			return 0;
 		}
-		std::cout << "\n";
-
+	}
+	catch (const std::exception& error)
+	{
+		std::cerr << error.what() << "\n";
+		return 1;
+	}
 
-		solution_template.add_job(job_id, input_data_line);
-		std::cout << "Job " << job_id << " added.\n";
+	if (!configuration.batch.empty())
+	{
+		// a missing batch, a malformed manifest or an unwritable results file, the instances themselves get their error records
+		try
+		{
+			return run_batch();
+		}
+		catch (const std::exception& error)
+		{
+			std::cerr << error.what() << std::endl;
+			return 1;
+		}
+	}
+	if (!configuration.serve.empty())
+	{
+		// an address it can't listen on or a failed accept, a bad request only gets its ERROR reply
+		try
+		{
+			return run_server();
+		}
+		catch (const std::exception& error)
+		{
+			std::cerr << error.what() << std::endl;
+			return 1;
+		}
+	}
 
-		++job_id;
-    }
-    
+	try
+	{
+		read_problem(configuration.problem_filename, solution_template);
+		// a decoder compiled for another problem is refused here, not once the run has started
+		if (configuration.solver_type == "genetic")
+		{
+			check_genetic_decoder(configuration.decoder_type, solution_template);
+		}
+		else if (configuration.solver_type == "portfolio")
+		{
+			for (const auto& member : parse_portfolio_members(configuration.portfolio, solution_template))
+			{
+				if (member->genetic_solver != nullptr)
+				{
+					check_genetic_decoder(member->genetic_solver->decoder, solution_template);
+				}
+			}
+		}
+	}
+	catch (const std::exception& error)
+	{
+		std::cerr << error.what() << std::endl;
+		return 1;
+	}
 	std::cout << "Done reading the file.\n";
 
-
 	std::cout << "Solution template:\n";
 	solution_template.print();
 
-	std::cout << "Horizon by us: " << horizon << " Horizon by template: " << solution_template.horizon() <<  "\n";
+	std::cout << "Horizon: " << solution_template.horizon() << "\n";
 	std::cout << "Absolute lowest_bound: " << solution_template.absolute_lowest_bound() << "\n";
 
-	solve_using_genetic_algorithm();
+	const uint64_t seed = make_seed(std::cout);
+	std::cout << "Threads: " << configuration.thread_count() << "\n";
+	std::cout << "SIMD kernels: " << kernel_table<int>().name << "\n";
+
+	// the local search solvers start from one random compacted schedule, for the big instances it's repaired on all the threads
+	// (the only parallel repair, the GA repairs every child on one thread inside its own parallel loops)
+	CounterRandom initial_random_engine(seed, 0, 0, RandomStream::Initialisation);
+	TaskScheduler decoding_scheduler(configuration.thread_count());
+	ParallelDecoder initial_decoder(solution_template, decoding_scheduler);
+	// every new best schedule goes out as soon as it's found
+	std::unique_ptr<ImprovementPublisher> improvement_publisher;
+	if (!configuration.improvements_filename.empty())
+	{
+		try
+		{
+			improvement_publisher = std::make_unique<ImprovementPublisher>(configuration.improvements_filename);
+		}
+		catch (const std::exception& error)
+		{
+			std::cerr << error.what() << std::endl;
+			return 1;
+		}
+	}
+	AnnealingSettings annealing_settings = make_annealing_settings();
+	annealing_settings.improvement_listener = improvement_publisher.get();
+	GeneticSettings genetic_settings = make_genetic_settings();
+	genetic_settings.improvement_listener = improvement_publisher.get();
+	Chromosome best;
+	// an island which can't reach its coordinator, or a solver which gives up, ends the run with its error
+	try
+	{
+		if (configuration.solver_type == "genetic")
+		{
+			// an island takes its seed from the coordinator, so the islands don't all search the same way
+			std::unique_ptr<IslandWorkerLink> island_link;
+			uint64_t genetic_seed = seed;
+			if (!configuration.island_address.empty())
+			{
+				island_link = std::make_unique<IslandWorkerLink>(configuration.island_address, solution_template);
+				genetic_seed = island_link->seed;
+				std::cout << "Island " << island_link->island << " of the coordinator at " << configuration.island_address << ", seed " << genetic_seed << "\n";
+			}
+			GeneticSettings settings = genetic_settings;
+			settings.migration_link = island_link.get();
+			const auto& solver = find_genetic_solver(configuration.crossover_type, configuration.selection_type, configuration.mutation_type, configuration.decoder_type);
+			std::cout << "GA (" << configuration.genetic_mode << "): " << solver.crossover << " / " << solver.selection << " / " << solver.mutation << " / " << solver.decoder << "\n";
+			best = solver.solve(solution_template, settings, genetic_seed);
+			if (island_link)
+			{
+				solution_template.fill_start_times(best);
+				island_link->send_result(best, solution_template.total_runtime());
+			}
+		}
+		else if (configuration.solver_type == "island coordinator")
+		{
+			best = run_island_coordinator(solution_template, configuration.island_address, configuration.islands, seed);
+			report_solution(best);
+		}
+		else if (configuration.solver_type == "portfolio")
+		{
+			const PortfolioSettings portfolio_settings{
+				.members = configuration.portfolio,
+				.threads = configuration.thread_count(),
+				.round_time = configuration.portfolio_round_time,
+				.rounds = configuration.portfolio_rounds,
+				.time_limit = configuration.time_limit,
+				.genetic = genetic_settings,
+				.annealing = annealing_settings,
+				.tempering_exchange_interval = configuration.tempering_exchange_interval,
+			};
+			best = solve_using_portfolio(solution_template, make_chromosome<int>(initial_random_engine, initial_decoder), portfolio_settings, seed);
+			report_solution(best);
+		}
+		else if (configuration.solver_type == "annealing")
+		{
+			best = solve_using_simulated_annealing(solution_template, make_chromosome<int>(initial_random_engine, initial_decoder), annealing_settings, seed);
+			report_solution(best);
+		}
+		else if (configuration.solver_type == "parallel tempering")
+		{
+			best = solve_using_parallel_tempering(solution_template, make_chromosome<int>(initial_random_engine, initial_decoder), annealing_settings,
+				configuration.tempering_replicas, configuration.tempering_exchange_interval, seed);
+			report_solution(best);
+		}
+		else
+		{
+			throw std::runtime_error("Unknown solver type.");
+		}
+	}
+	catch (const std::exception& error)
+	{
+		std::cerr << error.what() << std::endl;
+		return 1;
+	}
+
+	if (improvement_publisher)
+	{
+		improvement_publisher->finish();
+		std::cout << "Improvements: " << improvement_publisher->published_count() << " published, " << improvement_publisher->superseded_count()
+			<< " superseded before they were written, in " << configuration.improvements_filename << "\n";
+	}
+	if (!configuration.solution_filename.empty())
+	{
+		write_solution(best, configuration.solution_filename);
+	}
 
 	// uncomment only for debugging purposes
 	// single_test();
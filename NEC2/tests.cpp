@@ -0,0 +1,322 @@
+/*
+ * Checks of the properties the solvers rely on, built and run by `make test` from this directory (it reads the problem files here).
+ * Every test prints its name and "ok" or what failed, the exit code is the number of the failed tests.
+ */
+
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "common.h"
+#include "Random.h"
+#include "SolutionTemplate.h"
+#include "IncrementalSchedule.h"
+#include "GeneticAlgorithm.h"
+
+struct TestFailure : std::runtime_error
+{
+	using std::runtime_error::runtime_error;
+};
+
+/* fails the current test with the message */
+void expect(bool condition, const std::string& what)
+{
+	if (!condition)
+	{
+		throw TestFailure(what);
+	}
+}
+
+/* the problem file in this directory */
+SolutionTemplate load_problem(const std::string& filename)
+{
+	SolutionTemplate solution_template;
+	read_problem(filename, solution_template);
+	return solution_template;
+}
+
+/* random start times anywhere below the horizon, full of conflicts, like the ones the GA starts from */
+Chromosome random_start_times(SolutionTemplate& solution_template, uint32_t number)
+{
+	CounterRandom random_engine(12345, 0, number, RandomStream::Initialisation);
+	Chromosome start_times(solution_template.get_graph().tasks_count());
+	for (auto& start_time : start_times)
+	{
+		start_time = static_cast<int>(random_below(random_engine, static_cast<uint32_t>(solution_template.horizon())));
+	}
+	return start_times;
+}
+
+/* -------- compaction -------- */
+
+/* the left shift only ever moves tasks earlier into the gaps, so it can't lengthen a schedule, and what it gives is a schedule */
+void compaction_never_lengthens_and_stays_feasible()
+{
+	for (const auto& filename : { "ft06.txt", "la16.txt", "la40seti5.txt" })
+	{
+		SolutionTemplate solution_template = load_problem(filename);
+		for (uint32_t number = 0; number < 50; ++number)
+		{
+			solution_template.fill_start_times(random_start_times(solution_template, number));
+			solution_template.resolve_conflicts();
+			const int resolved_runtime = solution_template.total_runtime();
+			expect(solution_template.is_feasible(), std::string(filename) + ": the resolved schedule isn't feasible");
+
+			expect(solution_template.compact(), std::string(filename) + ": the unbounded compaction gave up");
+			// refilled, so the machines are in the order of the new start times, which `is_feasible()` needs
+			solution_template.fill_start_times(solution_template.get_chromosome<int>());
+			const int compacted_runtime = solution_template.total_runtime();
+			expect(solution_template.is_feasible(), std::string(filename) + ": the compacted schedule isn't feasible");
+			expect(compacted_runtime <= resolved_runtime, std::string(filename) + ": the compaction lengthened " + std::to_string(resolved_runtime)
+				+ " to " + std::to_string(compacted_runtime));
+		}
+	}
+}
+
+/* -------- incremental schedule -------- */
+
+/* a compacted schedule of the problem with the order of tasks on the machines to start the moves from */
+IncrementalSchedule random_incremental_schedule(SolutionTemplate& solution_template, uint32_t number)
+{
+	solution_template.fill_start_times(random_start_times(solution_template, number));
+	solution_template.resolve_conflicts();
+	solution_template.compact();
+	return IncrementalSchedule(solution_template, solution_template.get_chromosome<int>());
+}
+
+/* the estimate is the longest path through the swapped pair after the swap, the makespan can't be shorter than that */
+void estimate_is_a_lower_bound()
+{
+	for (const auto& filename : { "ft06.txt", "la16.txt" })
+	{
+		SolutionTemplate solution_template = load_problem(filename);
+		for (uint32_t number = 0; number < 20; ++number)
+		{
+			IncrementalSchedule schedule = random_incremental_schedule(solution_template, number);
+			for (int machine_id = 0; machine_id < schedule.machines_count(); ++machine_id)
+			{
+				for (int position = 0; position + 1 < schedule.machine_length(machine_id); ++position)
+				{
+					if (!schedule.is_swap_safe(machine_id, position))
+					{
+						continue;
+					}
+					const int estimate = schedule.evaluate_swap(machine_id, position, MoveEvaluation::Estimate);
+					const int exact = schedule.evaluate_swap(machine_id, position, MoveEvaluation::Exact);
+					expect(estimate <= exact, std::string(filename) + ": the estimate " + std::to_string(estimate) + " is above the makespan "
+						+ std::to_string(exact) + " on the machine " + std::to_string(machine_id) + " at " + std::to_string(position));
+				}
+			}
+		}
+	}
+}
+
+/* a series of moves undone in the reverse order leaves the heads, the tails and the makespan exactly as they were */
+void undo_restores_the_schedule()
+{
+	SolutionTemplate solution_template = load_problem("la16.txt");
+	const int tasks_count = solution_template.get_graph().tasks_count();
+	for (uint32_t number = 0; number < 20; ++number)
+	{
+		IncrementalSchedule schedule = random_incremental_schedule(solution_template, number);
+		const Chromosome heads = schedule.get_chromosome();
+		std::vector<int> tails(tasks_count);
+		for (int task_index = 0; task_index < tasks_count; ++task_index)
+		{
+			tails[task_index] = schedule.tail(task_index);
+		}
+		const int makespan = schedule.makespan();
+
+		CounterRandom random_engine(777, 0, number, RandomStream::Mutation);
+		int applied{ 0 };
+		for (int attempt = 0; attempt < 200; ++attempt)
+		{
+			const int machine_id = static_cast<int>(random_below(random_engine, static_cast<uint32_t>(schedule.machines_count())));
+			const int position = static_cast<int>(random_below(random_engine, static_cast<uint32_t>(schedule.machine_length(machine_id) - 1)));
+			if (schedule.is_swap_safe(machine_id, position))
+			{
+				schedule.apply_swap(machine_id, position);
+				++applied;
+			}
+		}
+		expect(applied > 0, "no safe move to apply");
+		for (int i = 0; i < applied; ++i)
+		{
+			schedule.undo();
+		}
+
+		expect(schedule.get_chromosome() == heads, "the heads differ after the undo");
+		for (int task_index = 0; task_index < tasks_count; ++task_index)
+		{
+			expect(schedule.tail(task_index) == tails[task_index], "the tail of the task " + std::to_string(task_index) + " differs after the undo");
+		}
+		expect(schedule.makespan() == makespan, "the makespan differs after the undo");
+	}
+}
+
+/* -------- counter-based random numbers -------- */
+
+/* the first block of Philox4x32-10 with the zero key and the zero counter, the known answer from Random123 */
+void philox_matches_the_known_answer()
+{
+	CounterRandom random_engine(0, 0, 0, RandomStream::Initialisation);
+	const uint32_t expected[4] = { 0x6627E8D5u, 0xE169C58Du, 0xBC57AC4Cu, 0x9B00DBD8u };
+	for (int i = 0; i < 4; ++i)
+	{
+		expect(random_engine() == expected[i], "the word " + std::to_string(i) + " of the first block is wrong");
+	}
+}
+
+/* the numbers are a function of the seed and the coordinates only, whatever was drawn from the other streams before */
+void philox_streams_are_deterministic()
+{
+	const auto draw = [](uint64_t seed, uint32_t generation, uint32_t specimen_index, RandomStream stream) {
+		CounterRandom random_engine(seed, generation, specimen_index, stream);
+		std::vector<uint32_t> words(10); // over two blocks
+		for (auto& word : words)
+		{
+			word = random_engine();
+		}
+		return words;
+	};
+
+	const auto reference = draw(42, 7, 3, RandomStream::Crossover);
+	// other streams in between, as the other threads would draw them
+	draw(42, 7, 4, RandomStream::Crossover);
+	draw(42, 8, 3, RandomStream::Mutation);
+	expect(draw(42, 7, 3, RandomStream::Crossover) == reference, "the same coordinates gave different numbers");
+
+	expect(draw(43, 7, 3, RandomStream::Crossover) != reference, "another seed gave the same numbers");
+	expect(draw(42, 8, 3, RandomStream::Crossover) != reference, "another generation gave the same numbers");
+	expect(draw(42, 7, 4, RandomStream::Crossover) != reference, "another specimen gave the same numbers");
+	expect(draw(42, 7, 3, RandomStream::Mutation) != reference, "another stream gave the same numbers");
+	expect(std::vector<uint32_t>(reference.begin(), reference.begin() + 4) != std::vector<uint32_t>(reference.begin() + 4, reference.begin() + 8),
+		"the second block repeats the first one");
+}
+
+/* -------- problem reader -------- */
+
+/* the message `read_problem()` throws for the text, empty if it reads it */
+std::string problem_error(const std::string& text)
+{
+	std::istringstream stream(text);
+	SolutionTemplate solution_template;
+	try
+	{
+		read_problem(stream, solution_template);
+	}
+	catch (const std::runtime_error& error)
+	{
+		return error.what();
+	}
+	return "";
+}
+
+/* every malformed problem is refused with its reason, before anything is built from it, and the well-formed ones are read */
+void reader_rejects_malformed_problems()
+{
+	const std::vector<std::pair<std::string, std::string>> malformed = {
+		{ "0 3 1 2\n1 4 0", "a machine without its length" },
+		{ "0 3 1 x\n1 4 0 2", "a word among the numbers" },
+		{ "0 3 1 2.5\n1 4 0 2", "a fractional length" },
+		{ "0 3 -1 2\n1 4 0 2", "a negative machine ID" },
+		{ "0 3 1 0\n1 4 0 2", "a zero length" },
+		{ "0 3 1 2\n\n1 4 0 2", "an empty job between the others" },
+		{ "0 3\n1 4", "fewer than 3 tasks" },
+		{ "0 3 2 2\n2 4 0 2", "a machine ID with a gap below it" },
+		{ "0 3 1000000 2\n1 4 0 2", "a huge machine ID" },
+		{ "0 2000000000 1 2\n1 2000000000 0 2", "a total length the start times can't hold" },
+		{ "", "no tasks at all" },
+	};
+	for (const auto& [text, what] : malformed)
+	{
+		expect(!problem_error(text).empty(), "accepted " + what);
+	}
+
+	expect(problem_error("0 3 1 2\n1 4 0 2\n\n\n").empty(), "refused the blank lines at the end");
+	std::istringstream stream("0 3 1 2\n1 4 0 2\n");
+	SolutionTemplate solution_template;
+	read_problem(stream, solution_template);
+	expect(solution_template.get_graph().tasks_count() == 4 && solution_template.get_graph().jobs_count() == 2
+		&& solution_template.get_graph().machines_count() == 2, "read the wrong sizes");
+}
+
+/* -------- genetic algorithm -------- */
+
+/* a short quiet generational run */
+GeneticSettings small_generational_settings(int threads)
+{
+	return GeneticSettings{
+		.mode = GeneticMode::Generational,
+		.population_size = 200,
+		.generations = 20,
+		.mutation_probability = 10,
+		.min_mutation_value = -2,
+		.max_mutation_value = 2,
+		.is_duplicate_elimination_enabled = true,
+		.heavy_mutation_value = 20,
+		.diversity_sample_size = 32,
+		.fitness_cache_capacity = 4096,
+		.time_limit = 0.0,
+		.threads = threads,
+		.tournament_size = 4,
+		.evaluations = 0,
+		.migration_link = nullptr,
+		.migration_interval = 10,
+		.migrants_count = 4,
+		.is_quiet = true,
+		.scheduler = nullptr,
+		.improvement_listener = nullptr,
+	};
+}
+
+/* every random decision is keyed on its coordinates and the stages are merged in a fixed order, so the threads change nothing */
+void generational_run_is_the_same_on_any_number_of_threads()
+{
+	SolutionTemplate solution_template = load_problem("la16.txt");
+	for (const auto& decoder : { "compacting", "push-later" })
+	{
+		const GeneticSolver& solver = find_genetic_solver("2-point", "tainted", "uniform XOR", decoder);
+		const Chromosome reference = solver.solve(solution_template, small_generational_settings(1), 2024);
+		for (const int threads : { 2, 4 })
+		{
+			expect(solver.solve(solution_template, small_generational_settings(threads), 2024) == reference,
+				std::string(decoder) + ": the best schedule on " + std::to_string(threads) + " threads differs from the one on 1 thread");
+		}
+	}
+}
+
+/* -------- the runner -------- */
+
+int main()
+{
+	const std::vector<std::pair<std::string, std::function<void()>>> tests = {
+		{ "compaction never lengthens and stays feasible", compaction_never_lengthens_and_stays_feasible },
+		{ "incremental schedule: the estimate is a lower bound", estimate_is_a_lower_bound },
+		{ "incremental schedule: undo restores the schedule", undo_restores_the_schedule },
+		{ "philox: the known answer", philox_matches_the_known_answer },
+		{ "philox: the streams are deterministic", philox_streams_are_deterministic },
+		{ "the reader rejects malformed problems", reader_rejects_malformed_problems },
+		{ "the generational GA is the same on any number of threads", generational_run_is_the_same_on_any_number_of_threads },
+	};
+
+	int failed{ 0 };
+	for (const auto& [name, test] : tests)
+	{
+		try
+		{
+			test();
+			std::cout << "ok      " << name << "\n";
+		}
+		catch (const std::exception& error)
+		{
+			std::cout << "FAILED  " << name << ": " << error.what() << "\n";
+			++failed;
+		}
+	}
+	std::cout << tests.size() - failed << " of " << tests.size() << " tests passed.\n";
+	return failed;
+}